@@ -0,0 +1,142 @@
+/**************************************************************
+ *
+ *                     arrayfile.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the arrayfile interface: the payload
+ *       checksum and reading and writing the 64-byte header.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arrayfile.h>
+
+/* ArrayFile_sum_init
+ * Purpose: Resets a checksum to the value of an empty payload
+ * Parameters: a pointer to the checksum state
+ * Returns: none
+ */
+void ArrayFile_sum_init(ArrayFile_sum *sum)
+{
+    assert (sum != NULL);
+
+    sum->a = 0;
+    sum->b = 0;
+    sum->tail_len = 0;
+}
+
+/* ArrayFile_sum_add
+ * Purpose: Adds the next bytes of a payload to a running checksum
+ * Parameters: a pointer to the checksum state, a pointer to the bytes,
+ *             and the number of bytes
+ * Returns: none
+ *
+ *       Note: Bytes that do not fill a whole 32-bit word are kept in
+ *             sum->tail until the next call completes the word.
+ */
+void ArrayFile_sum_add(ArrayFile_sum *sum, const void *bytes, size_t len)
+{
+    assert (sum != NULL && (bytes != NULL || len == 0));
+
+    const unsigned char *p = bytes;
+    uint64_t a = sum->a;
+    uint64_t b = sum->b;
+    uint32_t word;
+
+    while (sum->tail_len > 0 && sum->tail_len < 4 && len > 0) {
+        sum->tail[sum->tail_len++] = *p++;
+        len--;
+    }
+    if (sum->tail_len == 4) {
+        memcpy(&word, sum->tail, 4);
+        a += word;
+        b += a;
+        sum->tail_len = 0;
+    }
+
+    for (; len >= 4; p += 4, len -= 4) {
+        memcpy(&word, p, 4);
+        a += word;
+        b += a;
+    }
+
+    while (len > 0) {
+        sum->tail[sum->tail_len++] = *p++;
+        len--;
+    }
+
+    sum->a = a;
+    sum->b = b;
+}
+
+/* ArrayFile_sum_final
+ * Purpose: Returns the checksum of every byte added so far
+ * Parameters: a pointer to the checksum state
+ * Returns: the 64-bit checksum
+ *
+ *       Note: A partial last word is padded with zero bytes.
+ */
+uint64_t ArrayFile_sum_final(ArrayFile_sum *sum)
+{
+    assert (sum != NULL);
+
+    uint64_t a = sum->a;
+    uint64_t b = sum->b;
+
+    if (sum->tail_len > 0) {
+        uint32_t word = 0;
+        memcpy(&word, sum->tail, sum->tail_len);
+        a += word;
+        b += a;
+    }
+
+    return a ^ ((b << 32) | (b >> 32));
+}
+
+/* ArrayFile_write_header
+ * Purpose: Fills in the fixed fields of a header and writes it to a file
+ * Parameters: a pointer to the header and a file pointer for the output
+ * Returns: none
+ */
+void ArrayFile_write_header(ArrayFile_header *header, FILE *fp)
+{
+    assert (header != NULL && fp != NULL);
+
+    memset(header->magic, 0, sizeof(header->magic));
+    memcpy(header->magic, ARRAYFILE_MAGIC, sizeof(ARRAYFILE_MAGIC));
+    header->version = ARRAYFILE_VERSION;
+    header->byte_order = ARRAYFILE_BYTE_ORDER;
+    header->flags = 0;
+
+    size_t written = fwrite(header, sizeof(*header), 1, fp);
+    assert (written == 1);
+}
+
+/* ArrayFile_read_header
+ * Purpose: Reads and validates a header from a file
+ * Parameters: a pointer to the header to fill in, the expected kind, and
+ *             a file pointer for the input stream
+ * Returns: none
+ */
+void ArrayFile_read_header(ArrayFile_header *header, ArrayFile_kind kind,
+                                                               FILE *fp)
+{
+    assert (header != NULL && fp != NULL);
+
+    size_t read = fread(header, sizeof(*header), 1, fp);
+    assert (read == 1);
+
+    assert (memcmp(header->magic, ARRAYFILE_MAGIC,
+                                  sizeof(ARRAYFILE_MAGIC)) == 0);
+    assert (header->version == ARRAYFILE_VERSION);
+    assert (header->byte_order == ARRAYFILE_BYTE_ORDER);
+    assert (header->kind == (uint32_t)kind);
+    assert ((header->flags & ~ARRAYFILE_UNSEALED) == 0);
+    assert (header->width > 0 && header->height > 0);
+}
@@ -0,0 +1,142 @@
+/**************************************************************
+ *
+ *                     arrayfile.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The arrayfile interface describes the binary on-disk format
+ *     shared by Bit2_save/Bit2_load and UArray2_save/UArray2_load.
+ *     A file is a 64-byte header followed immediately by the raw
+ *     payload, exactly as it is laid out in memory, so a saved
+ *     array can be read back with one read or mapped with mmap
+ *     and used in place.
+ *
+ **************************************************************/
+
+#ifndef __ARRAYFILE__
+#define __ARRAYFILE__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define ARRAYFILE_MAGIC "A2ARRAY"
+#define ARRAYFILE_VERSION 1
+#define ARRAYFILE_BYTE_ORDER 0x01020304u
+
+/* Set in flags while a mapped payload may have changed since its
+ * checksum was computed; readers then skip the checksum */
+#define ARRAYFILE_UNSEALED 0x1u
+
+/* Which ADT a file holds */
+typedef enum {
+    ArrayFile_BIT2 = 1,
+    ArrayFile_UARRAY2 = 2
+} ArrayFile_kind;
+
+/* How the payload is arranged. stride is the distance in bytes from
+ * the start of one row (or column, or block) to the start of the next. */
+typedef enum {
+    ArrayFile_ROWS_MSB_FIRST = 1,   /* packed bit rows, as in P4 */
+    ArrayFile_COL_MAJOR = 2,        /* one column of elements at a time */
+    ArrayFile_ROW_MAJOR = 3,        /* one row of elements at a time */
+    ArrayFile_BLOCKED = 4           /* square blocks, row-major inside */
+} ArrayFile_layout;
+
+/* The 64-byte file header. Fields are stored in the byte order of the
+ * machine that wrote the file; byte_order lets a reader detect a file
+ * from a machine of the other endianness. The payload starts at byte
+ * sizeof(ArrayFile_header). */
+typedef struct ArrayFile_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t layout;
+    uint32_t elem_size;
+    uint32_t width;
+    uint32_t height;
+    uint64_t stride;
+    uint64_t payload_size;
+    uint64_t checksum;
+    uint32_t byte_order;
+    uint32_t flags;
+} ArrayFile_header;
+
+/* Running state of the payload checksum */
+typedef struct ArrayFile_sum {
+    uint64_t a;
+    uint64_t b;
+    unsigned char tail[4];
+    int tail_len;
+} ArrayFile_sum;
+
+/* ArrayFile_sum_init
+ * Purpose: Resets a checksum to the value of an empty payload
+ * Parameters: a pointer to the checksum state
+ * Returns: none
+ * Expected input: a non-null pointer
+ * Success output: none
+ * Failure output: if the pointer is null, a Hanson CRE is raised
+ */
+void ArrayFile_sum_init(ArrayFile_sum *sum);
+
+/* ArrayFile_sum_add
+ * Purpose: Adds the next bytes of a payload to a running checksum
+ * Parameters: a pointer to the checksum state, a pointer to the bytes,
+ *             and the number of bytes
+ * Returns: none
+ * Expected input: an initialized checksum and a buffer of len bytes
+ * Success output: none
+ * Failure output: if either pointer is null, a Hanson CRE is raised
+ *           Note: The result does not depend on how the payload is split
+ *                 into calls, so arrays that are not contiguous in memory
+ *                 can be summed piece by piece.
+ */
+void ArrayFile_sum_add(ArrayFile_sum *sum, const void *bytes, size_t len);
+
+/* ArrayFile_sum_final
+ * Purpose: Returns the checksum of every byte added so far
+ * Parameters: a pointer to the checksum state
+ * Returns: the 64-bit checksum
+ * Expected input: an initialized checksum
+ * Success output: the checksum value
+ * Failure output: if the pointer is null, a Hanson CRE is raised
+ *           Note: The checksum is a Fletcher-style pair of running sums
+ *                 over 32-bit words, so it is computed at memory speed.
+ */
+uint64_t ArrayFile_sum_final(ArrayFile_sum *sum);
+
+/* ArrayFile_write_header
+ * Purpose: Fills in the fixed fields of a header and writes it to a file
+ * Parameters: a pointer to a header whose kind, layout, elem_size,
+ *             width, height, stride, payload_size and checksum are set,
+ *             and a file pointer for the output stream
+ * Returns: none
+ * Expected input: a non-null header and an output stream open for writing
+ * Success output: 64 header bytes are written, with no flags set
+ * Failure output: if either pointer is null or the write fails, a Hanson
+ *                 CRE is raised
+ */
+void ArrayFile_write_header(ArrayFile_header *header, FILE *fp);
+
+/* ArrayFile_read_header
+ * Purpose: Reads and validates a header from a file
+ * Parameters: a pointer to the header to fill in, the ArrayFile_kind the
+ *             caller expects, and a file pointer for the input stream
+ * Returns: none
+ * Expected input: a non-null header and an input stream positioned at
+ *                 the start of a saved array
+ * Success output: the header is filled in and the stream is positioned
+ *                 at the start of the payload
+ * Failure output: if the read fails, if the magic, version, byte order
+ *                 or kind do not match, or if an unknown flag is set, a
+ *                 Hanson CRE is raised
+ */
+void ArrayFile_read_header(ArrayFile_header *header, ArrayFile_kind kind,
+                                                               FILE *fp);
+
+#endif /* __ARRAYFILE__ */
@@ -0,0 +1,441 @@
+/**************************************************************
+ *
+ *          bench_sudoku – timing harness for sudoku checking
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Usage:
+ *       bench_sudoku [benchmark [args...]]
+ *
+ *       With no arguments every benchmark runs with its default
+ *       arguments. Each benchmark prints one line per measurement.
+ *
+ *     Benchmarks:
+ *       batch [puzzles]
+ *         Generates puzzles (default 1000000) by relabeling digits and
+ *         shuffling the rows and bands of a solution, breaking one in
+ *         four, writes them to a temporary file in the compact format
+ *         and as P2 and P5 PGMs, and times reading and checking the
+ *         whole stream with one Sudoku_T, in puzzles per second.
+ *       grids [grids] [reps]
+ *         Times Sudoku_check_grids on the same generated grids (default
+ *         100000, held in memory) with each kernel this machine runs,
+ *         over reps passes (default 20), in grids per second on one
+ *         core.
+ *       scaling [puzzles]
+ *         Times Sudoku_batch on a generated compact stream (default
+ *         2000000 puzzles) with 1, 2, 4, 8, 16 and 32 threads, writing
+ *         the verdicts to /dev/null, and reports each speedup over one
+ *         thread. Counts above the machine's processors are still run.
+ *       solve [reps] [file]
+ *         Solves a set of hard puzzles reps times (default 200) with
+ *         Sudoku_solve, also checking each for uniqueness, and reports
+ *         puzzles per second. The set is a compact file, with '.' or
+ *         '0' for blanks (top95 and similar lists work as they are),
+ *         or a few well-known hard puzzles built in.
+ *
+ *     Build with optimization for meaningful numbers; the Makefile's
+ *     CFLAGS already include -O2.
+ *
+ **************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <sudokucheck.h>
+#include <parallel.h>
+
+typedef struct Benchmark {
+    const char *name;
+    void (*run)(int argc, char *argv[]);
+} Benchmark;
+
+static double now_ms(void);
+static int int_arg(int argc, char *argv[], int i, int fallback);
+
+static void make_puzzle(int cells[81], unsigned *seed);
+static FILE *write_stream(int num_puzzles, Sudoku_format format, int raw);
+static void time_stream(const char *what, FILE *stream, int num_puzzles,
+                        Sudoku_format format);
+static void bench_batch(int argc, char *argv[]);
+static void bench_grids(int argc, char *argv[]);
+static void bench_scaling(int argc, char *argv[]);
+static void bench_solve(int argc, char *argv[]);
+
+/* Arto Inkala's 2012 puzzle, Easter Monster, the hardest of Norvig's
+ * top95 for his solver, and AI Escargot */
+static const char *hard_puzzles[] = {
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85"
+    "...1..9....4..",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3.."
+    ".9.8...2.....1",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5.."
+    "2.....1.4......",
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4."
+    ".....7..7...3..",
+};
+
+static Benchmark benchmarks[] = {
+    { "batch", bench_batch },
+    { "grids", bench_grids },
+    { "scaling", bench_scaling },
+    { "solve", bench_solve },
+};
+
+int main(int argc, char *argv[])
+{
+    int num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    if (argc < 2) {
+        for (int i = 0; i < num_benchmarks; i++) {
+            benchmarks[i].run(0, NULL);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < num_benchmarks; i++) {
+        if (strcmp(argv[1], benchmarks[i].name) == 0) {
+            benchmarks[i].run(argc - 2, argv + 2);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "Usage: %s [benchmark [args...]]\n", argv[0]);
+    fprintf(stderr, "Benchmarks:");
+    for (int i = 0; i < num_benchmarks; i++) {
+        fprintf(stderr, " %s", benchmarks[i].name);
+    }
+    fprintf(stderr, "\n");
+
+    return 1;
+}
+
+/* bench_batch
+ *    Purpose: Time checking a stream of puzzles in both formats
+ * Parameters: an optional number of puzzles (default 1000000)
+ *    Returns: void
+ */
+static void bench_batch(int argc, char *argv[])
+{
+    int num_puzzles = int_arg(argc, argv, 0, 1000000);
+
+    printf("batch: %d puzzles, one in four broken\n", num_puzzles);
+
+    FILE *stream = write_stream(num_puzzles, Sudoku_COMPACT, 0);
+    time_stream("compact", stream, num_puzzles, Sudoku_COMPACT);
+    fclose(stream);
+
+    stream = write_stream(num_puzzles, Sudoku_PGM, 0);
+    time_stream("pgm, plain", stream, num_puzzles, Sudoku_PGM);
+    fclose(stream);
+
+    stream = write_stream(num_puzzles, Sudoku_PGM, 1);
+    time_stream("pgm, raw", stream, num_puzzles, Sudoku_PGM);
+    fclose(stream);
+}
+
+/* bench_grids
+ *    Purpose: Time each Sudoku_check_grids kernel on in-memory grids
+ * Parameters: optional numbers of grids (default 100000) and of passes
+ *             (default 20)
+ *    Returns: void
+ */
+static void bench_grids(int argc, char *argv[])
+{
+    static const char *names[] = { "best", "scalar", "SSE2", "AVX2" };
+    int num_grids = int_arg(argc, argv, 0, 100000);
+    int reps = int_arg(argc, argv, 1, 20);
+
+    uint8_t *grids = malloc((size_t)num_grids * 81);
+    uint8_t *solved = malloc(num_grids);
+    assert (grids != NULL && solved != NULL);
+
+    unsigned seed = 40;
+    int cells[81];
+    for (int g = 0; g < num_grids; g++) {
+        make_puzzle(cells, &seed);
+        if (g % 4 == 3) {
+            cells[80] = cells[79];
+        }
+        for (int i = 0; i < 81; i++) {
+            grids[(size_t)g * 81 + i] = cells[i];
+        }
+    }
+
+    printf("grids: %d grids x %d passes, one in four broken in the last "
+           "cell\n", num_grids, reps);
+
+    for (int k = Sudoku_SCALAR; k <= Sudoku_AVX2; k++) {
+        if (!Sudoku_has_kernel(k)) {
+            printf("  %-26s not available\n", names[k]);
+            continue;
+        }
+
+        int total = 0;
+        double start = now_ms();
+        for (int r = 0; r < reps; r++) {
+            total += Sudoku_check_grids(grids, num_grids, solved, k);
+        }
+        double ms = now_ms() - start;
+        assert (total == reps * (num_grids - num_grids / 4));
+
+        printf("  %-26s %10.2f ms %12.0f grids/s\n", names[k], ms,
+               ms > 0 ? (double)num_grids * reps / ms * 1000.0 : 0.0);
+    }
+
+    free(grids);
+    free(solved);
+}
+
+/* bench_scaling
+ *    Purpose: Time Sudoku_batch on a compact stream at growing thread
+ *             counts
+ * Parameters: an optional number of puzzles (default 2000000)
+ *    Returns: void
+ */
+static void bench_scaling(int argc, char *argv[])
+{
+    int num_puzzles = int_arg(argc, argv, 0, 2000000);
+    FILE *stream = write_stream(num_puzzles, Sudoku_COMPACT, 0);
+    FILE *devnull = fopen("/dev/null", "w");
+    assert (devnull != NULL);
+
+    printf("scaling: %d compact puzzles, %d processors\n", num_puzzles,
+           Parallel_default_threads());
+
+    double base = 0;
+    for (int threads = 1; threads <= 32; threads *= 2) {
+        rewind(stream);
+
+        double start = now_ms();
+        int unsolved = Sudoku_batch(stream, devnull, threads);
+        double ms = now_ms() - start;
+        assert (unsolved == num_puzzles / 4);
+
+        if (threads == 1) {
+            base = ms;
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "%d threads", threads);
+        printf("  %-26s %10.2f ms %12.0f puzzles/s  %6.2fx\n", label, ms,
+               ms > 0 ? num_puzzles / ms * 1000.0 : 0.0,
+               ms > 0 ? base / ms : 0.0);
+    }
+
+    fclose(devnull);
+    fclose(stream);
+}
+
+/* bench_solve
+ *    Purpose: Time Sudoku_solve on a set of hard puzzles
+ * Parameters: an optional number of passes (default 200) and an optional
+ *             compact file of puzzles
+ *    Returns: void
+ */
+static void bench_solve(int argc, char *argv[])
+{
+    int reps = int_arg(argc, argv, 0, 200);
+    FILE *stream;
+
+    if (argc > 1) {
+        stream = fopen(argv[1], "r");
+        assert (stream != NULL);
+    } else {
+        stream = tmpfile();
+        assert (stream != NULL);
+        int count = sizeof(hard_puzzles) / sizeof(hard_puzzles[0]);
+        for (int i = 0; i < count; i++) {
+            fprintf(stream, "%s\n", hard_puzzles[i]);
+        }
+    }
+
+    Sudoku_T sudoku = Sudoku_new();
+    int num_puzzles = 0;
+    int unique = 0;
+
+    double start = now_ms();
+    for (int r = 0; r < reps; r++) {
+        rewind(stream);
+        while (Sudoku_read(sudoku, stream, Sudoku_COMPACT)) {
+            int found = Sudoku_solve(sudoku, 2);
+            assert (found == 0 || Sudoku_check(sudoku));
+            unique += (found == 1);
+            num_puzzles++;
+        }
+    }
+    double ms = now_ms() - start;
+
+    printf("solve: %d puzzles x %d passes, %d with a unique solution\n",
+           num_puzzles / reps, reps, unique / reps);
+    printf("  %-26s %10.2f ms %12.0f puzzles/s\n", "solve and check unique",
+           ms, ms > 0 ? num_puzzles / ms * 1000.0 : 0.0);
+
+    Sudoku_free(&sudoku);
+    fclose(stream);
+}
+
+/* time_stream
+ *    Purpose: Read and check every puzzle of a stream, and print the
+ *             rate
+ * Parameters: a label, the stream, the number of puzzles in it, and its
+ *             format
+ *    Returns: void
+ */
+static void time_stream(const char *what, FILE *stream, int num_puzzles,
+                        Sudoku_format format)
+{
+    Sudoku_T sudoku = Sudoku_new();
+    int solved = 0;
+    int read = 0;
+
+    double start = now_ms();
+    while (Sudoku_read(sudoku, stream, format)) {
+        solved += Sudoku_check(sudoku);
+        read++;
+    }
+    double ms = now_ms() - start;
+
+    Sudoku_free(&sudoku);
+    assert (read == num_puzzles && solved == num_puzzles - num_puzzles / 4);
+
+    printf("  %-26s %10.2f ms %12.0f puzzles/s\n", what, ms,
+           ms > 0 ? num_puzzles / ms * 1000.0 : 0.0);
+}
+
+/* write_stream
+ *    Purpose: Write generated puzzles to a temporary file
+ * Parameters: the number of puzzles, the format to write them in, and
+ *             whether PGMs are raw (P5) rather than plain (P2)
+ *    Returns: the file, rewound to its start
+ *
+ *       Note: Every fourth puzzle has two cells of a row swapped, which
+ *             breaks only its columns.
+ */
+static FILE *write_stream(int num_puzzles, Sudoku_format format, int raw)
+{
+    FILE *stream = tmpfile();
+    assert (stream != NULL);
+
+    unsigned seed = 40;
+    int cells[81];
+
+    for (int p = 0; p < num_puzzles; p++) {
+        make_puzzle(cells, &seed);
+        if (p % 4 == 3) {
+            int first = cells[0];
+            cells[0] = cells[1];
+            cells[1] = first;
+        }
+
+        if (format == Sudoku_COMPACT) {
+            for (int i = 0; i < 81; i++) {
+                putc('0' + cells[i], stream);
+            }
+            putc('\n', stream);
+        } else if (raw) {
+            fputs("P5\n9 9\n9\n", stream);
+            for (int i = 0; i < 81; i++) {
+                putc(cells[i], stream);
+            }
+        } else {
+            fputs("P2\n9 9\n9\n", stream);
+            for (int i = 0; i < 81; i++) {
+                putc('0' + cells[i], stream);
+                putc(i % 9 == 8 ? '\n' : ' ', stream);
+            }
+        }
+    }
+
+    rewind(stream);
+
+    return stream;
+}
+
+/* make_puzzle
+ *    Purpose: Generate a random solved sudoku
+ * Parameters: the array for the 81 cells, row by row, and the random
+ *             seed
+ *    Returns: void
+ *
+ *       Note: The digits of a fixed solution are relabeled, and its
+ *             bands and the rows within each band are shuffled; all of
+ *             these keep a solution solved.
+ */
+static void make_puzzle(int cells[81], unsigned *seed)
+{
+    int label[9];
+    int band[3] = { 0, 1, 2 };
+    int rows[3][3] = { { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 } };
+
+    for (int i = 0; i < 9; i++) {
+        label[i] = i + 1;
+    }
+    for (int i = 8; i > 0; i--) {
+        *seed = *seed * 1103515245u + 12345u;
+        int j = (*seed >> 16) % (i + 1);
+        int swap = label[i];
+        label[i] = label[j];
+        label[j] = swap;
+    }
+    for (int b = 0; b < 3; b++) {
+        *seed = *seed * 1103515245u + 12345u;
+        int j = (*seed >> 16) % 3;
+        int swap = band[b];
+        band[b] = band[j];
+        band[j] = swap;
+
+        *seed = *seed * 1103515245u + 12345u;
+        j = (*seed >> 16) % 3;
+        swap = rows[b][0];
+        rows[b][0] = rows[b][j];
+        rows[b][j] = swap;
+    }
+
+    for (int row = 0; row < 9; row++) {
+        int from = band[row / 3] * 3 + rows[row / 3][row % 3];
+
+        for (int col = 0; col < 9; col++) {
+            cells[row * 9 + col] = label[(from % 3 * 3 + from / 3 + col)
+                                         % 9];
+        }
+    }
+}
+
+/* now_ms
+ *    Purpose: Read a monotonic clock
+ * Parameters: none
+ *    Returns: the time in milliseconds
+ */
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* int_arg
+ *    Purpose: Read an optional positive integer argument
+ * Parameters: the benchmark's argc and argv, the index of the argument,
+ *             and the value to use if it is missing
+ *    Returns: the argument's value or the fallback
+ */
+static int int_arg(int argc, char *argv[], int i, int fallback)
+{
+    if (i >= argc) {
+        return fallback;
+    }
+
+    int value = atoi(argv[i]);
+    assert (value > 0);
+
+    return value;
+}
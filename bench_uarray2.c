@@ -0,0 +1,599 @@
+/**************************************************************
+ *
+ *          bench_uarray2 – timing harness for UArray2
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Usage:
+ *       bench_uarray2 [benchmark [args...]]
+ *
+ *       With no arguments every benchmark runs with its default
+ *       arguments. Each benchmark prints one line per measurement
+ *       with the time in milliseconds.
+ *
+ *     Benchmarks:
+ *       storage [width height]
+ *         Compares the single-allocation UArray2 against the original
+ *         layout (a Hanson UArray of per-column UArrays): creating and
+ *         freeing many small arrays, and row-major and column-major
+ *         traversal by map and by UArray2_at.
+ *
+ *       typed [width height]
+ *         Compares the generic UArray2 with the typed variants of
+ *         uarray2typed.h: int32_t sums through at/get and through
+ *         map_default, and a uint8_t threshold kernel written with
+ *         UArray2_at against one over typed row pointers.
+ *
+ *       order [max_side]
+ *         Runs a 5-point stencil through map_row_major, map_col_major
+ *         and map_block_major (default tile) on column-major arrays of
+ *         1-, 4- and 16-byte elements, with sides doubling from 1024 to
+ *         max_side (default 4096). A 16384 side with 16-byte elements
+ *         needs 4 GB.
+ *
+ *       transpose [side]
+ *         Transposes a side x side column-major array (default 4096)
+ *         into a column-major copy, for 1-, 2-, 4- and 8-byte elements,
+ *         with a UArray2_map_col_major copy through UArray2_at against
+ *         UArray2_transpose, and times UArray2_transpose_square in
+ *         place. With a power-of-two side every column of a tile maps
+ *         to the same cache sets; compare a side such as 4000.
+ *
+ *     Build with optimization for meaningful numbers; the Makefile's
+ *     CFLAGS already include -O2.
+ *
+ **************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <uarray.h>
+#include <uarray2.h>
+#include <uarray2typed.h>
+
+typedef struct Benchmark {
+    const char *name;
+    void (*run)(int argc, char *argv[]);
+} Benchmark;
+
+/* The pre-contiguous UArray2 layout, kept here as the baseline */
+typedef struct ColumnArray {
+    UArray_T columns;
+    int width;
+    int height;
+} ColumnArray;
+
+/* Results are summed into this so the compiler cannot drop the loops */
+static volatile long sink;
+
+static double now_ms(void);
+static int int_arg(int argc, char *argv[], int i, int fallback);
+static void report(const char *what, double old_ms, double new_ms);
+
+static ColumnArray column_array_new(int width, int height, size_t size);
+static void *column_array_at(ColumnArray *array, int col, int row);
+static void column_array_free(ColumnArray *array);
+
+static void sum_element(int col, int row, UArray2_T a, void *p1, void *p2);
+static void sum_i32(int col, int row, UArray2_i32_T a, int32_t *elem,
+                    void *cl);
+static void bench_storage(int argc, char *argv[]);
+static void bench_typed(int argc, char *argv[]);
+static void bench_order(int argc, char *argv[]);
+static void bench_transpose(int argc, char *argv[]);
+static void stencil(int col, int row, UArray2_T a, void *p1, void *p2);
+static void copy_transposed(int col, int row, UArray2_T a, void *p1,
+                            void *p2);
+
+static Benchmark benchmarks[] = {
+    { "storage", bench_storage },
+    { "typed", bench_typed },
+    { "order", bench_order },
+    { "transpose", bench_transpose },
+};
+
+int main(int argc, char *argv[])
+{
+    int num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    if (argc < 2) {
+        for (int i = 0; i < num_benchmarks; i++) {
+            benchmarks[i].run(0, NULL);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < num_benchmarks; i++) {
+        if (strcmp(argv[1], benchmarks[i].name) == 0) {
+            benchmarks[i].run(argc - 2, argv + 2);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "Usage: %s [benchmark [args...]]\n", argv[0]);
+    fprintf(stderr, "Benchmarks:");
+    for (int i = 0; i < num_benchmarks; i++) {
+        fprintf(stderr, " %s", benchmarks[i].name);
+    }
+    fprintf(stderr, "\n");
+
+    return 1;
+}
+
+/* bench_storage
+ *    Purpose: Compare the original per-column layout with the contiguous
+ *             UArray2 for allocation and for both traversal orders
+ * Parameters: optional width and height of the large array (default
+ *             4096 x 4096 ints)
+ *    Returns: void
+ */
+static void bench_storage(int argc, char *argv[])
+{
+    int width = int_arg(argc, argv, 0, 4096);
+    int height = int_arg(argc, argv, 1, 4096);
+    double start, old_ms, new_ms;
+    long sum;
+
+    printf("storage: %d x %d ints\n", width, height);
+    printf("  %-26s %13s %13s\n", "", "per-column", "contiguous");
+
+    /* Create and free 9 x 9 arrays, the sudoku checker's pattern */
+    start = now_ms();
+    for (int i = 0; i < 100000; i++) {
+        ColumnArray small = column_array_new(9, 9, sizeof(int));
+        column_array_free(&small);
+    }
+    old_ms = now_ms() - start;
+
+    start = now_ms();
+    for (int i = 0; i < 100000; i++) {
+        UArray2_T small = UArray2_new(9, 9, sizeof(int));
+        UArray2_free(&small);
+    }
+    new_ms = now_ms() - start;
+    report("new+free 9x9 (x100000)", old_ms, new_ms);
+
+    ColumnArray old_array = column_array_new(width, height, sizeof(int));
+    UArray2_T new_array = UArray2_new(width, height, sizeof(int));
+
+    for (int col = 0; col < width; col++) {
+        for (int row = 0; row < height; row++) {
+            *(int *)column_array_at(&old_array, col, row) = col ^ row;
+            *(int *)UArray2_at(new_array, col, row) = col ^ row;
+        }
+    }
+
+    /* Row-major traversal through at */
+    sum = 0;
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            sum += *(int *)column_array_at(&old_array, col, row);
+        }
+    }
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            sum += *(int *)UArray2_at(new_array, col, row);
+        }
+    }
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("row-major at", old_ms, new_ms);
+
+    /* Column-major traversal through at */
+    sum = 0;
+    start = now_ms();
+    for (int col = 0; col < width; col++) {
+        for (int row = 0; row < height; row++) {
+            sum += *(int *)column_array_at(&old_array, col, row);
+        }
+    }
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    for (int col = 0; col < width; col++) {
+        for (int row = 0; row < height; row++) {
+            sum += *(int *)UArray2_at(new_array, col, row);
+        }
+    }
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("col-major at", old_ms, new_ms);
+
+    /* The map functions; the baseline is the original map loop */
+    sum = 0;
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            UArray_T column = *(UArray_T *)UArray_at(old_array.columns, col);
+            sum_element(col, row, NULL, UArray_at(column, row), &sum);
+        }
+    }
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    UArray2_map_row_major(new_array, sum_element, &sum);
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("map_row_major", old_ms, new_ms);
+
+    sum = 0;
+    start = now_ms();
+    for (int col = 0; col < width; col++) {
+        UArray_T column = *(UArray_T *)UArray_at(old_array.columns, col);
+        for (int row = 0; row < height; row++) {
+            sum_element(col, row, NULL, UArray_at(column, row), &sum);
+        }
+    }
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    UArray2_map_col_major(new_array, sum_element, &sum);
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("map_col_major", old_ms, new_ms);
+
+    column_array_free(&old_array);
+    UArray2_free(&new_array);
+}
+
+/* bench_typed
+ *    Purpose: Compare generic UArray2 access with the typed variants
+ * Parameters: optional width and height of the arrays (default 4096 x
+ *             4096)
+ *    Returns: void
+ */
+static void bench_typed(int argc, char *argv[])
+{
+    int width = int_arg(argc, argv, 0, 4096);
+    int height = int_arg(argc, argv, 1, 4096);
+    double start, old_ms, new_ms;
+    long sum;
+
+    printf("typed: %d x %d\n", width, height);
+    printf("  %-26s %13s %13s\n", "", "generic", "typed");
+
+    UArray2_T generic = UArray2_new_order(width, height, sizeof(int32_t),
+                                          UArray2_ROW_MAJOR);
+    UArray2_i32_T typed = UArray2_i32_new_order(width, height,
+                                                UArray2_ROW_MAJOR);
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            *(int32_t *)UArray2_at(generic, col, row) = col ^ row;
+            UArray2_i32_put(typed, col, row, col ^ row);
+        }
+    }
+
+    sum = 0;
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            sum += *(int32_t *)UArray2_at(generic, col, row);
+        }
+    }
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            sum += UArray2_i32_get(typed, col, row);
+        }
+    }
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("i32 sum by at/get", old_ms, new_ms);
+
+    sum = 0;
+    start = now_ms();
+    UArray2_map_default(generic, sum_element, &sum);
+    old_ms = now_ms() - start;
+    sink += sum;
+
+    sum = 0;
+    start = now_ms();
+    UArray2_i32_map_default(typed, sum_i32, &sum);
+    new_ms = now_ms() - start;
+    sink += sum;
+    report("i32 sum by map_default", old_ms, new_ms);
+
+    UArray2_i32_free(&typed);
+    UArray2_free(&generic);
+
+    /* Threshold a gray image to 0/255 */
+    UArray2_T gray = UArray2_new_order(width, height, sizeof(uint8_t),
+                                       UArray2_ROW_MAJOR);
+    UArray2_u8_T gray_typed = UArray2_u8_new_order(width, height,
+                                                   UArray2_ROW_MAJOR);
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            uint8_t value = (col * 7 + row * 13) & 0xFF;
+            *(uint8_t *)UArray2_at(gray, col, row) = value;
+            UArray2_u8_put(gray_typed, col, row, value);
+        }
+    }
+
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            uint8_t *pixel = UArray2_at(gray, col, row);
+            *pixel = *pixel >= 128 ? 255 : 0;
+        }
+    }
+    old_ms = now_ms() - start;
+
+    start = now_ms();
+    for (int row = 0; row < height; row++) {
+        uint8_t *pixels = UArray2_u8_row(gray_typed, row);
+
+        for (int col = 0; col < width; col++) {
+            pixels[col] = pixels[col] >= 128 ? 255 : 0;
+        }
+    }
+    new_ms = now_ms() - start;
+    report("u8 threshold", old_ms, new_ms);
+
+    sink += *(uint8_t *)UArray2_at(gray, width - 1, height - 1)
+            + UArray2_u8_get(gray_typed, width - 1, height - 1);
+
+    UArray2_u8_free(&gray_typed);
+    UArray2_free(&gray);
+}
+
+/* bench_order
+ *    Purpose: Time a stencil under the three map orders for a range of
+ *             array sizes and element sizes
+ * Parameters: optional largest side (default 4096)
+ *    Returns: void
+ */
+static void bench_order(int argc, char *argv[])
+{
+    int max_side = int_arg(argc, argv, 0, 4096);
+    int elem_sizes[] = { 1, 4, 16 };
+
+    printf("order: 5-point stencil, column-major storage\n");
+    printf("  %6s %5s %5s %12s %12s %12s\n", "side", "size", "tile",
+           "row ms", "col ms", "block ms");
+
+    for (int side = 1024; side <= max_side; side *= 2) {
+        for (int i = 0; i < 3; i++) {
+            UArray2_T array = UArray2_new(side, side, elem_sizes[i]);
+            double start, row_ms, col_ms, block_ms;
+            long sum = 0;
+
+            start = now_ms();
+            UArray2_map_row_major(array, stencil, &sum);
+            row_ms = now_ms() - start;
+
+            start = now_ms();
+            UArray2_map_col_major(array, stencil, &sum);
+            col_ms = now_ms() - start;
+
+            start = now_ms();
+            UArray2_map_block_major(array, 0, stencil, &sum);
+            block_ms = now_ms() - start;
+
+            sink += sum;
+            printf("  %6d %5d %5d %12.2f %12.2f %12.2f\n", side,
+                   elem_sizes[i], UArray2_default_tile(array), row_ms,
+                   col_ms, block_ms);
+
+            UArray2_free(&array);
+        }
+    }
+}
+
+/* bench_transpose
+ *    Purpose: Compare a naive element-by-element transpose with
+ *             UArray2_transpose, and time UArray2_transpose_square
+ * Parameters: optional side of the square arrays (default 4096)
+ *    Returns: void
+ */
+static void bench_transpose(int argc, char *argv[])
+{
+    int side = int_arg(argc, argv, 0, 4096);
+    int elem_sizes[] = { 1, 2, 4, 8 };
+
+    printf("transpose: %d x %d, column-major to column-major\n", side,
+           side);
+
+    for (int i = 0; i < 4; i++) {
+        UArray2_T src = UArray2_new(side, side, elem_sizes[i]);
+        UArray2_T dst = UArray2_new(side, side, elem_sizes[i]);
+        double start, naive_ms, transpose_ms;
+        char what[64];
+
+        start = now_ms();
+        UArray2_map_col_major(src, copy_transposed, dst);
+        naive_ms = now_ms() - start;
+
+        start = now_ms();
+        UArray2_transpose(dst, src);
+        transpose_ms = now_ms() - start;
+
+        snprintf(what, sizeof(what), "%d-byte map vs transpose",
+                 elem_sizes[i]);
+        report(what, naive_ms, transpose_ms);
+
+        start = now_ms();
+        UArray2_transpose_square(src);
+        printf("  %-26s %10.2f ms\n", "in place", now_ms() - start);
+
+        UArray2_free(&dst);
+        UArray2_free(&src);
+    }
+}
+
+/* stencil
+ *    Purpose: map apply function that sums the first byte of an element
+ *             and of its four neighbors, writing the low bits back
+ * Parameters: the column, row, array, element pointer, and a void
+ *             pointer to a long checksum
+ *    Returns: void
+ */
+static void stencil(int col, int row, UArray2_T a, void *p1, void *p2)
+{
+    int last_col = UArray2_width(a) - 1;
+    int last_row = UArray2_height(a) - 1;
+    unsigned char *center = p1;
+
+    int total = *center
+        + *(unsigned char *)UArray2_at(a, col > 0 ? col - 1 : 0, row)
+        + *(unsigned char *)UArray2_at(a, col < last_col ? col + 1 : col, row)
+        + *(unsigned char *)UArray2_at(a, col, row > 0 ? row - 1 : 0)
+        + *(unsigned char *)UArray2_at(a, col, row < last_row ? row + 1
+                                                                : row);
+
+    *center = total & 0x7F;
+    *(long *)p2 += total;
+}
+
+/* copy_transposed
+ *    Purpose: map apply function that copies an element to the mirror
+ *             position of another array, the naive way
+ * Parameters: the column, row, source array, element pointer, and the
+ *             destination UArray2 as a void pointer
+ *    Returns: void
+ */
+static void copy_transposed(int col, int row, UArray2_T a, void *p1,
+                            void *p2)
+{
+    memcpy(UArray2_at(p2, row, col), p1, UArray2_size(a));
+}
+
+/* sum_element
+ *    Purpose: map apply function that adds an int element to a long sum
+ * Parameters: the column, row, array, element pointer, and a void
+ *             pointer to the long sum
+ *    Returns: void
+ */
+static void sum_element(int col, int row, UArray2_T a, void *p1, void *p2)
+{
+    (void)col;
+    (void)row;
+    (void)a;
+    *(long *)p2 += *(int *)p1;
+}
+
+/* sum_i32
+ *    Purpose: typed map apply function that adds an element to a long sum
+ * Parameters: the column, row, array, element pointer, and a void
+ *             pointer to the long sum
+ *    Returns: void
+ */
+static void sum_i32(int col, int row, UArray2_i32_T a, int32_t *elem,
+                    void *cl)
+{
+    (void)col;
+    (void)row;
+    (void)a;
+    *(long *)cl += *elem;
+}
+
+/* column_array_new
+ *    Purpose: Build the original UArray2 layout: one Hanson UArray per
+ *             column plus an outer UArray of handles
+ * Parameters: the width, height and element size
+ *    Returns: the ColumnArray
+ */
+static ColumnArray column_array_new(int width, int height, size_t size)
+{
+    ColumnArray array;
+    array.width = width;
+    array.height = height;
+    array.columns = UArray_new(width, sizeof(UArray_T));
+
+    for (int col = 0; col < width; col++) {
+        *(UArray_T *)UArray_at(array.columns, col) = UArray_new(height,
+                                                                size);
+    }
+
+    return array;
+}
+
+/* column_array_at
+ *    Purpose: The original UArray2_at: two bounds-checked lookups
+ * Parameters: the ColumnArray and the column and row
+ *    Returns: a pointer to the element
+ */
+static void *column_array_at(ColumnArray *array, int col, int row)
+{
+    UArray_T column = *(UArray_T *)UArray_at(array->columns, col);
+
+    return UArray_at(column, row);
+}
+
+/* column_array_free
+ *    Purpose: Free every column and the outer array of a ColumnArray
+ * Parameters: a pointer to the ColumnArray
+ *    Returns: void
+ */
+static void column_array_free(ColumnArray *array)
+{
+    for (int col = 0; col < array->width; col++) {
+        UArray_free((UArray_T *)UArray_at(array->columns, col));
+    }
+    UArray_free(&array->columns);
+}
+
+/* now_ms
+ *    Purpose: Read a monotonic clock
+ * Parameters: none
+ *    Returns: the current time in milliseconds
+ */
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* int_arg
+ *    Purpose: Read an optional positive integer argument
+ * Parameters: the benchmark's argc and argv, the index of the argument,
+ *             and the value to use if it is missing
+ *    Returns: the argument's value or the fallback
+ */
+static int int_arg(int argc, char *argv[], int i, int fallback)
+{
+    if (i >= argc) {
+        return fallback;
+    }
+
+    int value = atoi(argv[i]);
+    assert (value > 0);
+
+    return value;
+}
+
+/* report
+ *    Purpose: Print one baseline-versus-new measurement
+ * Parameters: a label and the two times in milliseconds
+ *    Returns: void
+ */
+static void report(const char *what, double old_ms, double new_ms)
+{
+    printf("  %-26s %10.2f ms %10.2f ms  %6.2fx\n", what, old_ms, new_ms,
+           new_ms > 0 ? old_ms / new_ms : 0.0);
+}
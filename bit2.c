@@ -7,26 +7,70 @@
  *     Date:     Oct 4, 2021
  *
  *     Summary
- *       Implementation of the bit2 interface. Based on David Hanson's
- *       unboxed array, this file contains functions for making 2D
- *       bitmaps, getting its width and height, getting a bit at
- *       a given index, and putting a bit at a given index.
+ *       Implementation of the bit2 interface. Bits are packed into
+ *       rows of bytes, most significant bit first, exactly as in the
+ *       raster of a raw (P4) pbm file. This file contains functions
+ *       for making 2D bitmaps or wrapping existing packed buffers,
+ *       getting its width and height, getting a bit at a given index,
+ *       and putting a bit at a given index.
  *
  **************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <uarray.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
 #include <bit2.h>
+#include <parallel.h>
+#include <arrayfile.h>
 
 #define T Bit2_T
 
+/* Rows allocated by Bit2_new are padded to a multiple of this many bytes
+ * so that every row starts on a 64-bit boundary */
+#define ROW_ALIGN 8
+
 struct T {
-    UArray_T col_uarray;
+    unsigned char *bits;
     int width;
     int height;
+    int stride;
+    int owns_bits;
+    int pooled;             /* struct and bits belong to a Pool */
 };
 
+/* Shared state handed to every worker of Bit2_map_parallel */
+typedef struct MapParallelData {
+    T bit2;
+    void (*apply)(int col, int row, T a, int b, void *p1);
+    void *cl;
+    size_t cl_size;
+    char *thread_cls;
+} MapParallelData;
+
+/* A Bit2 unpacked into 64-bit words for the morphological operators.
+ * Column 0 of a row is the top bit of the row's first word, matching
+ * the MSB-first bytes, and bits past the last column are always 0. */
+typedef struct WordMap {
+    uint64_t *words;
+    int words_per_row;
+    int width;
+    int height;
+} WordMap;
+
+static void map_parallel_band(int worker, int num_workers, void *cl);
+static WordMap words_from_bit2(T bit2);
+static T words_to_bit2(WordMap *map);
+static void complement_words(WordMap *map);
+static void dilate_words(WordMap *map, Bit2_shape shape, int radius);
+static void dilate_row(uint64_t *src, uint64_t *dst, int num_words,
+                                                      int radius);
+static void dilate_columns(uint64_t *src, uint64_t *dst, int num_words,
+                                             int height, int radius);
+static uint64_t tail_mask(int width);
+static void transpose_64(uint64_t *rows);
+
 /* Bit2_new
  * Purpose: Creates a new Bit2 of a given width and height
  * Parameters: integers representing width and height of the Bit2
@@ -39,20 +83,80 @@ struct T {
 T Bit2_new(int width, int height){
     assert (width > 0 && height > 0);
 
-    T new_bit2 = malloc(sizeof(struct T));
+    int row_bytes = (width + 7) / 8;
+    int stride = (row_bytes + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+
+    unsigned char *bits = calloc((size_t)height, stride);
+    assert (bits != NULL);
+
+    return Bit2_wrap(bits, width, height, stride, 1);
+}
+
+/* Bit2_new_pool
+ * Purpose: Creates a new Bit2 whose storage comes from a Pool
+ * Parameters: integers representing width and height of the Bit2, and
+ *             the Pool (or NULL for the heap)
+ * Returns: the new Bit2
+ * Expected input: a width and height that are both greater than 0
+ * Success output: a new, all-zero Bit2 bitmap is returned
+ * Failure output: if the width or height are invalid, a Hanson CRE
+ *                 is raised
+ */
+T Bit2_new_pool(int width, int height, Pool_T pool)
+{
+    if (pool == NULL) {
+        return Bit2_new(width, height);
+    }
+
+    assert (width > 0 && height > 0);
+
+    int row_bytes = (width + 7) / 8;
+    int stride = (row_bytes + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+
+    unsigned char *bits = Pool_alloc(pool, (size_t)height * stride,
+                                     ROW_ALIGN);
+    memset(bits, 0, (size_t)height * stride);
+
+    T new_bit2 = Pool_alloc(pool, sizeof(struct T), sizeof(void *));
+    new_bit2->bits = bits;
     new_bit2->width = width;
     new_bit2->height = height;
+    new_bit2->stride = stride;
+    new_bit2->owns_bits = 0;
+    new_bit2->pooled = 1;
 
-    UArray_T col_uarray = UArray_new(width, sizeof(Bit_T));
-    assert (col_uarray != NULL);
-    
-    for (int i = 0; i < width; i++) {
-        Bit_T *empty_column = UArray_at(col_uarray, i);
-        Bit_T bit_column = Bit_new(height);
-        *empty_column = bit_column;
-    }
-    
-    new_bit2->col_uarray = col_uarray;
+    return new_bit2;
+}
+
+/* Bit2_wrap
+ * Purpose: Creates a Bit2 whose storage is an existing packed buffer
+ * Parameters: a pointer to the buffer, integers representing the width
+ *             and height of the Bit2, the number of bytes from the start
+ *             of one row to the start of the next, and an ownership flag
+ * Returns: the new Bit2
+ * Expected input: a non-null buffer of at least height * stride bytes,
+ *                 a width and height greater than 0, and a stride of at
+ *                 least (width + 7) / 8
+ * Success output: a new Bit2 that reads and writes the buffer in place
+ * Failure output: if the buffer is null or the dimensions or stride are
+ *                 invalid, a Hanson CRE is raised
+ */
+T Bit2_wrap(unsigned char *bits, int width, int height, int stride,
+                                                        int owns_bits)
+{
+    assert (bits != NULL);
+    assert (width > 0 && height > 0);
+    assert (stride >= (width + 7) / 8);
+
+    T new_bit2 = malloc(sizeof(struct T));
+    assert (new_bit2 != NULL);
+
+    new_bit2->bits = bits;
+    new_bit2->width = width;
+    new_bit2->height = height;
+    new_bit2->stride = stride;
+    new_bit2->owns_bits = owns_bits;
+    new_bit2->pooled = 0;
 
     return new_bit2;
 }
@@ -72,10 +176,10 @@ int Bit2_get(T bit2, int col, int row){
     assert (bit2 != NULL);
     assert (col < bit2->width && col >= 0);
     assert (row < bit2->height && row >= 0);
-    
-    Bit_T *bit_column = UArray_at(bit2->col_uarray, col);
 
-    return Bit_get(*bit_column, row);
+    unsigned char byte = bit2->bits[(size_t)row * bit2->stride + col / 8];
+
+    return (byte >> (7 - col % 8)) & 1;
 }
 
 /* Bit2_put
@@ -95,10 +199,18 @@ int Bit2_put(T bit2, int col, int row, int value){
     assert (col < bit2->width && col >= 0);
     assert (row < bit2->height && row >= 0);
     assert (value == 0 || value == 1);
-    
-    Bit_T *bit_column = UArray_at(bit2->col_uarray, col);
 
-    return Bit_put(*bit_column, row, value);
+    unsigned char *byte = &bit2->bits[(size_t)row * bit2->stride + col / 8];
+    unsigned char mask = 0x80 >> (col % 8);
+    int prev = (*byte & mask) != 0;
+
+    if (value == 1) {
+        *byte |= mask;
+    } else {
+        *byte &= ~mask;
+    }
+
+    return prev;
 }
 
 /* Bit2_width
@@ -131,6 +243,85 @@ int Bit2_height(T bit2)
     return bit2->height;
 }
 
+/* Bit2_stride
+ * Purpose: Returns the number of bytes between the starts of two
+ *          consecutive rows of a given Bit2
+ * Parameters: the Bit2
+ * Returns: the row stride of the Bit2 in bytes
+ * Expected input: a valid Bit2
+ * Success output: returns the stride of the Bit2
+ * Failure output: if the Bit2 is null, a Hanson CRE is raised
+ */
+int Bit2_stride(T bit2)
+{
+    assert (bit2 != NULL);
+
+    return bit2->stride;
+}
+
+/* Bit2_row
+ * Purpose: Returns a pointer to the packed bytes of one row of a Bit2
+ * Parameters: the Bit2 and an int for the target row
+ * Returns: a pointer to the first byte of the row
+ * Expected input: a valid Bit2 and a row within the bounds of the Bit2
+ * Success output: a pointer to (width + 7) / 8 bytes holding the row,
+ *                 most significant bit first, that stays valid until the
+ *                 Bit2 is freed
+ * Failure output: if the Bit2 is null, or if the row is not within the
+ *                 bounds of the Bit2, a Hanson CRE is raised
+ */
+unsigned char *Bit2_row(T bit2, int row)
+{
+    assert (bit2 != NULL);
+    assert (row < bit2->height && row >= 0);
+
+    return bit2->bits + (size_t)row * bit2->stride;
+}
+
+/* Bit2_put_row
+ * Purpose: Stores a whole row of a Bit2 from packed bytes
+ * Parameters: the Bit2, an int for the target row, and a pointer to the
+ *             packed bytes
+ * Returns: none
+ * Expected input: a valid Bit2, a row within its bounds, and
+ *                 (width + 7) / 8 packed bytes
+ * Success output: the row holds the bytes' pixels
+ * Failure output: if the Bit2 or the bytes are null, or if the row is
+ *                 out of bounds, a Hanson CRE is raised
+ */
+void Bit2_put_row(T bit2, int row, const unsigned char *bytes)
+{
+    assert (bytes != NULL);
+
+    unsigned char *bit_row = Bit2_row(bit2, row);
+    int row_bytes = (bit2->width + 7) / 8;
+
+    memcpy(bit_row, bytes, row_bytes);
+    bit_row[row_bytes - 1] &= tail_mask(bit2->width % 8) >> 56;
+}
+
+/* Bit2_get_row
+ * Purpose: Copies a whole row of a Bit2 out as packed bytes
+ * Parameters: the Bit2, an int for the target row, and a pointer to the
+ *             buffer
+ * Returns: none
+ * Expected input: a valid Bit2, a row within its bounds, and a buffer of
+ *                 (width + 7) / 8 bytes
+ * Success output: the buffer holds the row's packed pixels
+ * Failure output: if the Bit2 or the buffer are null, or if the row is
+ *                 out of bounds, a Hanson CRE is raised
+ */
+void Bit2_get_row(T bit2, int row, unsigned char *bytes)
+{
+    assert (bytes != NULL);
+
+    unsigned char *bit_row = Bit2_row(bit2, row);
+    int row_bytes = (bit2->width + 7) / 8;
+
+    memcpy(bytes, bit_row, row_bytes);
+    bytes[row_bytes - 1] &= tail_mask(bit2->width % 8) >> 56;
+}
+
 /* Bit2_map_col_major
  * Purpose: Traverse a given Bit2 column by column starting from 
  *             the top left element, calling the apply function on each
@@ -156,10 +347,8 @@ void Bit2_map_col_major(T bit2, void apply(int col, int row, T a,
     assert (bit2 != NULL && apply != NULL);
     
     for (int col = 0; col < bit2->width; col++) {
-        Bit_T *bit_column = UArray_at(bit2->col_uarray, col);
-        
         for (int row = 0; row < bit2->height; row++) {
-            int curr_bit = Bit_get(*bit_column, row);
+            int curr_bit = Bit2_get(bit2, col, row);
             
             apply(col, row, bit2, curr_bit, cl);
         }
@@ -191,15 +380,290 @@ void Bit2_map_row_major(T bit2, void apply(int col, int row, T a,
     assert (bit2 != NULL && apply != NULL);
     
     for (int row = 0; row < bit2->height; row++) {
+        unsigned char *bit_row = Bit2_row(bit2, row);
+
         for (int col = 0; col < bit2->width; col++) {
-            Bit_T *bit_column = UArray_at(bit2->col_uarray, col);
-            int curr_bit = Bit_get(*bit_column, row);
+            int curr_bit = (bit_row[col / 8] >> (7 - col % 8)) & 1;
             
             apply(col, row, bit2, curr_bit, cl);
         }
     } 
 }
 
+/* Bit2_map_parallel
+ * Purpose: Traverse a given Bit2 with a pool of worker threads, each of
+ *             which visits a disjoint band of rows in row-major
+ *             order, calling the apply function on each element with
+ *             its own copy of the closure value, then folding the
+ *             per-thread closures back into the caller's closure
+ * Parameters: the Bit2, the number of worker threads (0 uses one per
+ *             online processor), the thread-safe apply function, the
+ *             closure value and its size in bytes, and the reduce function
+ * Returns: none
+ * Expected input: a valid Bit2, a non-negative thread count, a matching
+ *                 apply function, and a closure of cl_size bytes
+ * Success output: none
+ * Failure output: if either the Bit2 or the apply function are null, or
+ *                 if the thread count is negative, a Hanson CRE is raised
+ *           Note: Bands are made of whole rows because each row starts
+ *                 on its own byte, so workers never share a byte of storage.
+ */
+void Bit2_map_parallel(T bit2, int num_threads,
+                       void apply(int col, int row, T a, int b, void *p1),
+                       void *cl, size_t cl_size,
+                       void reduce(void *cl, void *thread_cl))
+{
+    assert (bit2 != NULL && apply != NULL);
+    assert (num_threads >= 0);
+    assert (cl_size == 0 || cl != NULL);
+
+    if (num_threads == 0) {
+        num_threads = Parallel_default_threads();
+    }
+    if (num_threads > bit2->height) {
+        num_threads = bit2->height;
+    }
+
+    MapParallelData data = { bit2, apply, cl, cl_size, NULL };
+
+    if (cl_size > 0) {
+        data.thread_cls = malloc(num_threads * cl_size);
+        assert (data.thread_cls != NULL);
+
+        for (int i = 0; i < num_threads; i++) {
+            memcpy(data.thread_cls + i * cl_size, cl, cl_size);
+        }
+    }
+
+    Parallel_run(num_threads, map_parallel_band, &data);
+
+    if (cl_size > 0) {
+        for (int i = 0; reduce != NULL && i < num_threads; i++) {
+            reduce(cl, data.thread_cls + i * cl_size);
+        }
+        free(data.thread_cls);
+    }
+}
+
+/* Bit2_save
+ * Purpose: Writes a Bit2 to a file in the binary arrayfile format
+ * Parameters: the Bit2 and a file pointer for the output stream
+ * Returns: none
+ * Expected input: a valid Bit2 and a stream open for binary writing
+ * Success output: the header and packed rows are written
+ * Failure output: if the Bit2 or file pointer is null, or if the write
+ *                 fails, a Hanson CRE is raised
+ */
+void Bit2_save(T bit2, FILE *fp)
+{
+    assert (bit2 != NULL && fp != NULL);
+
+    size_t payload_size = (size_t)bit2->height * bit2->stride;
+
+    ArrayFile_sum sum;
+    ArrayFile_sum_init(&sum);
+    ArrayFile_sum_add(&sum, bit2->bits, payload_size);
+
+    ArrayFile_header header;
+    header.kind = ArrayFile_BIT2;
+    header.layout = ArrayFile_ROWS_MSB_FIRST;
+    header.elem_size = 0;
+    header.width = bit2->width;
+    header.height = bit2->height;
+    header.stride = bit2->stride;
+    header.payload_size = payload_size;
+    header.checksum = ArrayFile_sum_final(&sum);
+
+    ArrayFile_write_header(&header, fp);
+
+    size_t written = fwrite(bit2->bits, 1, payload_size, fp);
+    assert (written == payload_size);
+}
+
+/* Bit2_load
+ * Purpose: Reads a Bit2 written by Bit2_save
+ * Parameters: a file pointer for the input stream
+ * Returns: the new Bit2, which owns its storage
+ * Expected input: a stream positioned at the start of a saved Bit2
+ * Success output: a Bit2 with the saved dimensions, stride and bits
+ * Failure output: if the file pointer is null, if the read fails, or if
+ *                 the header or checksum is invalid, a Hanson CRE is
+ *                 raised
+ */
+T Bit2_load(FILE *fp)
+{
+    assert (fp != NULL);
+
+    ArrayFile_header header;
+    ArrayFile_read_header(&header, ArrayFile_BIT2, fp);
+
+    assert (header.layout == ArrayFile_ROWS_MSB_FIRST);
+    assert (header.width <= INT_MAX && header.height <= INT_MAX);
+    assert (header.stride >= (header.width + 7) / 8);
+    assert (header.stride <= INT_MAX);
+    assert (header.payload_size == header.height * header.stride);
+
+    size_t payload_size = header.payload_size;
+    unsigned char *bits = malloc(payload_size);
+    assert (bits != NULL);
+
+    size_t read = fread(bits, 1, payload_size, fp);
+    assert (read == payload_size);
+
+    ArrayFile_sum sum;
+    ArrayFile_sum_init(&sum);
+    ArrayFile_sum_add(&sum, bits, payload_size);
+    assert (ArrayFile_sum_final(&sum) == header.checksum);
+
+    return Bit2_wrap(bits, header.width, header.height, header.stride, 1);
+}
+
+/* Bit2_dilate
+ * Purpose: Creates the morphological dilation of a Bit2
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_dilate(T bit2, Bit2_shape shape, int radius)
+{
+    assert (bit2 != NULL && radius >= 0);
+
+    WordMap map = words_from_bit2(bit2);
+    dilate_words(&map, shape, radius);
+
+    return words_to_bit2(&map);
+}
+
+/* Bit2_erode
+ * Purpose: Creates the morphological erosion of a Bit2
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ *
+ *       Note: Erosion is computed as the complement of the dilation of
+ *             the complement.
+ */
+T Bit2_erode(T bit2, Bit2_shape shape, int radius)
+{
+    assert (bit2 != NULL && radius >= 0);
+
+    WordMap map = words_from_bit2(bit2);
+    complement_words(&map);
+    dilate_words(&map, shape, radius);
+    complement_words(&map);
+
+    return words_to_bit2(&map);
+}
+
+/* Bit2_open
+ * Purpose: Creates the morphological opening of a Bit2
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_open(T bit2, Bit2_shape shape, int radius)
+{
+    assert (bit2 != NULL && radius >= 0);
+
+    WordMap map = words_from_bit2(bit2);
+    complement_words(&map);
+    dilate_words(&map, shape, radius);
+    complement_words(&map);
+    dilate_words(&map, shape, radius);
+
+    return words_to_bit2(&map);
+}
+
+/* Bit2_close
+ * Purpose: Creates the morphological closing of a Bit2
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_close(T bit2, Bit2_shape shape, int radius)
+{
+    assert (bit2 != NULL && radius >= 0);
+
+    WordMap map = words_from_bit2(bit2);
+    dilate_words(&map, shape, radius);
+    complement_words(&map);
+    dilate_words(&map, shape, radius);
+    complement_words(&map);
+
+    return words_to_bit2(&map);
+}
+
+/* Bit2_transpose
+ * Purpose: Creates the transpose of a Bit2
+ * Parameters: the Bit2
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2
+ * Success output: a new Bit2 whose pixel (row, col) is the original's
+ *                 pixel (col, row)
+ * Failure output: if the Bit2 is null, a Hanson CRE is raised
+ */
+T Bit2_transpose(T bit2)
+{
+    assert (bit2 != NULL);
+
+    WordMap src = words_from_bit2(bit2);
+    WordMap dst;
+    dst.width = src.height;
+    dst.height = src.width;
+    dst.words_per_row = (dst.width + 63) / 64;
+    dst.words = malloc((size_t)dst.words_per_row * dst.height
+                                                 * sizeof(uint64_t));
+    assert (dst.words != NULL);
+
+    /* Tile (w, band) of the source, 64 rows starting at 64 * band by
+     * one word, becomes tile (band, w) of the destination */
+    uint64_t tile[64];
+
+    for (int band = 0; band < dst.words_per_row; band++) {
+        int first_row = band * 64;
+        int rows = src.height - first_row < 64 ? src.height - first_row
+                                               : 64;
+
+        for (int w = 0; w < src.words_per_row; w++) {
+            for (int k = 0; k < 64; k++) {
+                tile[k] = k < rows ? src.words[(size_t)(first_row + k)
+                                               * src.words_per_row + w]
+                                   : 0;
+            }
+
+            transpose_64(tile);
+
+            int first_col = w * 64;
+            int cols = src.width - first_col < 64 ? src.width - first_col
+                                                  : 64;
+            for (int k = 0; k < cols; k++) {
+                dst.words[(size_t)(first_col + k) * dst.words_per_row
+                                                  + band] = tile[k];
+            }
+        }
+    }
+
+    free(src.words);
+
+    return words_to_bit2(&dst);
+}
+
 /* Bit2_free
  * Purpose: Frees memory associated with a given Bit2, including the
  *          elements stored inside of it.
@@ -213,11 +677,272 @@ void Bit2_map_row_major(T bit2, void apply(int col, int row, T a,
 void Bit2_free(T *bit2){
     assert (*bit2 != NULL && bit2 != NULL);
 
-    for (int col = 0; col < (*bit2)->width; col++) {
-        Bit_T *bit_column = UArray_at((*bit2)->col_uarray, col);
-        Bit_free(bit_column);
+    if ((*bit2)->owns_bits) {
+        free((*bit2)->bits);
+    }
+
+    if (!(*bit2)->pooled) {
+        free(*bit2);
+    }
+}
+
+/* map_parallel_band
+ *    Purpose: Worker body for Bit2_map_parallel; applies the caller's
+ *             function to every bit in this worker's band of rows
+ * Parameters: the worker index, the number of workers, and a void
+ *             pointer to the shared MapParallelData
+ *    Returns: void
+ */
+static void map_parallel_band(int worker, int num_workers, void *cl)
+{
+    MapParallelData *data = cl;
+    T bit2 = data->bit2;
+    void *worker_cl = data->cl;
+
+    if (data->cl_size > 0) {
+        worker_cl = data->thread_cls + worker * data->cl_size;
+    }
+
+    int lo, hi;
+    Parallel_band(bit2->height, num_workers, worker, &lo, &hi);
+
+    for (int row = lo; row < hi; row++) {
+        unsigned char *bit_row = Bit2_row(bit2, row);
+
+        for (int col = 0; col < bit2->width; col++) {
+            int curr_bit = (bit_row[col / 8] >> (7 - col % 8)) & 1;
+
+            data->apply(col, row, bit2, curr_bit, worker_cl);
+        }
+    }
+}
+
+/* words_from_bit2
+ *    Purpose: Unpacks the rows of a Bit2 into a new WordMap
+ * Parameters: the Bit2
+ *    Returns: the WordMap, whose words the caller must free
+ */
+static WordMap words_from_bit2(T bit2)
+{
+    WordMap map;
+    map.width = bit2->width;
+    map.height = bit2->height;
+    map.words_per_row = (bit2->width + 63) / 64;
+    map.words = malloc((size_t)map.words_per_row * map.height
+                                                 * sizeof(uint64_t));
+    assert (map.words != NULL);
+
+    int row_bytes = (bit2->width + 7) / 8;
+    uint64_t last_mask = tail_mask(bit2->width);
+
+    for (int row = 0; row < map.height; row++) {
+        unsigned char *bit_row = Bit2_row(bit2, row);
+        uint64_t *word_row = map.words + (size_t)row * map.words_per_row;
+
+        for (int w = 0; w < map.words_per_row; w++) {
+            uint64_t word = 0;
+
+            for (int k = 0; k < 8; k++) {
+                int byte = w * 8 + k;
+                uint64_t value = byte < row_bytes ? bit_row[byte] : 0;
+                word |= value << (56 - 8 * k);
+            }
+            word_row[w] = word;
+        }
+        word_row[map.words_per_row - 1] &= last_mask;
+    }
+
+    return map;
+}
+
+/* words_to_bit2
+ *    Purpose: Packs a WordMap into a new Bit2 and frees the WordMap
+ * Parameters: a pointer to the WordMap
+ *    Returns: the new Bit2
+ */
+static T words_to_bit2(WordMap *map)
+{
+    T bit2 = Bit2_new(map->width, map->height);
+    int row_bytes = (map->width + 7) / 8;
+
+    for (int row = 0; row < map->height; row++) {
+        unsigned char *bit_row = Bit2_row(bit2, row);
+        uint64_t *word_row = map->words + (size_t)row * map->words_per_row;
+
+        for (int byte = 0; byte < row_bytes; byte++) {
+            bit_row[byte] = word_row[byte / 8] >> (56 - 8 * (byte % 8));
+        }
+    }
+
+    free(map->words);
+    map->words = NULL;
+
+    return bit2;
+}
+
+/* complement_words
+ *    Purpose: Flips every pixel of a WordMap, leaving the bits past the
+ *             last column 0
+ * Parameters: a pointer to the WordMap
+ *    Returns: void
+ */
+static void complement_words(WordMap *map)
+{
+    uint64_t last_mask = tail_mask(map->width);
+
+    for (int row = 0; row < map->height; row++) {
+        uint64_t *word_row = map->words + (size_t)row * map->words_per_row;
+
+        for (int w = 0; w < map->words_per_row; w++) {
+            word_row[w] = ~word_row[w];
+        }
+        word_row[map->words_per_row - 1] &= last_mask;
+    }
+}
+
+/* dilate_words
+ *    Purpose: Dilates a WordMap in place with a square or cross
+ * Parameters: a pointer to the WordMap, the shape, and the radius
+ *    Returns: void
+ *
+ *       Note: A square is separable, so it is a row dilation followed by
+ *             a column dilation. A cross is the union of the two.
+ */
+static void dilate_words(WordMap *map, Bit2_shape shape, int radius)
+{
+    if (radius == 0) {
+        return;
+    }
+
+    int num_words = map->words_per_row;
+    size_t total = (size_t)num_words * map->height;
+    uint64_t last_mask = tail_mask(map->width);
+
+    uint64_t *rows_done = malloc(total * sizeof(uint64_t));
+    uint64_t *result = malloc(total * sizeof(uint64_t));
+    assert (rows_done != NULL && result != NULL);
+
+    for (int row = 0; row < map->height; row++) {
+        uint64_t *dst = rows_done + (size_t)row * num_words;
+
+        dilate_row(map->words + (size_t)row * num_words, dst, num_words,
+                                                              radius);
+        dst[num_words - 1] &= last_mask;
+    }
+
+    if (shape == Bit2_SQUARE) {
+        dilate_columns(rows_done, result, num_words, map->height, radius);
+    } else {
+        dilate_columns(map->words, result, num_words, map->height, radius);
+        for (size_t i = 0; i < total; i++) {
+            result[i] |= rows_done[i];
+        }
+    }
+
+    free(rows_done);
+    free(map->words);
+    map->words = result;
+}
+
+/* dilate_row
+ *    Purpose: Dilates one row of words horizontally: each output pixel is
+ *             the or of the input pixels at most radius columns away
+ * Parameters: the input row, the output row, the number of words in a
+ *             row, and the radius
+ *    Returns: void
+ *
+ *       Note: Shifting a row left by k moves column c + k into column c,
+ *             so each shift distance costs two word shifts and an or per
+ *             64 pixels. Words past either end of the row read as 0.
+ */
+static void dilate_row(uint64_t *src, uint64_t *dst, int num_words,
+                                                      int radius)
+{
+    for (int i = 0; i < num_words; i++) {
+        uint64_t acc = src[i];
+
+        for (int k = 1; k <= radius; k++) {
+            int q = k / 64;
+            int b = k % 64;
+
+            int ahead = i + q;
+            int behind = i - q;
+            uint64_t ahead_hi = ahead < num_words ? src[ahead] : 0;
+            uint64_t ahead_lo = ahead + 1 < num_words ? src[ahead + 1] : 0;
+            uint64_t behind_lo = behind >= 0 ? src[behind] : 0;
+            uint64_t behind_hi = behind - 1 >= 0 ? src[behind - 1] : 0;
+
+            if (b == 0) {
+                acc |= ahead_hi | behind_lo;
+            } else {
+                acc |= (ahead_hi << b) | (ahead_lo >> (64 - b));
+                acc |= (behind_lo >> b) | (behind_hi << (64 - b));
+            }
+        }
+
+        dst[i] = acc;
+    }
+}
+
+/* dilate_columns
+ *    Purpose: Dilates a WordMap's words vertically: each output row is the
+ *             or of the input rows at most radius rows away
+ * Parameters: the input words, the output words, the number of words in
+ *             a row, the number of rows, and the radius
+ *    Returns: void
+ */
+static void dilate_columns(uint64_t *src, uint64_t *dst, int num_words,
+                                             int height, int radius)
+{
+    for (int row = 0; row < height; row++) {
+        uint64_t *out = dst + (size_t)row * num_words;
+        int first = row - radius < 0 ? 0 : row - radius;
+        int last = row + radius >= height ? height - 1 : row + radius;
+
+        memcpy(out, src + (size_t)first * num_words,
+               num_words * sizeof(uint64_t));
+
+        for (int other = first + 1; other <= last; other++) {
+            uint64_t *in = src + (size_t)other * num_words;
+
+            for (int w = 0; w < num_words; w++) {
+                out[w] |= in[w];
+            }
+        }
+    }
+}
+
+/* tail_mask
+ *    Purpose: Returns the mask of the valid bits in the last word of a row
+ * Parameters: the width of the row in pixels
+ *    Returns: a word whose top (width - 1) % 64 + 1 bits are set
+ */
+static uint64_t tail_mask(int width)
+{
+    int used = width % 64;
+
+    return used == 0 ? ~(uint64_t)0 : ~(uint64_t)0 << (64 - used);
+}
+
+/* transpose_64
+ *    Purpose: Transposes a 64 x 64 bit matrix in place
+ * Parameters: the matrix as 64 rows of 64 bits, column 0 in the most
+ *             significant bit
+ *    Returns: void
+ *
+ *       Note: Each round swaps the off-diagonal quarters of every block
+ *             of side 2j with one masked exchange per pair of rows, for
+ *             j = 32, 16, ..., 1 (Hacker's Delight, section 7-3).
+ */
+static void transpose_64(uint64_t *rows)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+
+    for (int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t swap = (rows[k] ^ (rows[k | j] >> j)) & mask;
+            rows[k] ^= swap;
+            rows[k | j] ^= swap << j;
+        }
     }
-    
-    UArray_free(&(*bit2)->col_uarray);
-    free(*bit2);
 }
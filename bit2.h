@@ -10,6 +10,9 @@
  *     The bit2 interface is an abstraction that implements
  *     two-dimensional, unboxed arrays of bits, which is
  *     especially useful for efficiently storing images.
+ *     Each row is packed most significant bit first, the same
+ *     layout as the raster of a raw (P4) pbm file, so a Bit2
+ *     can wrap a decoded page without copying it.
  *
  **************************************************************/
 
@@ -18,12 +21,21 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <bit.h>
 #include <assert.h>
+#include <pool.h>
 #define T Bit2_T
 
 typedef struct T *T;
 
+/* Structuring elements for the morphological operators. A square of
+ * radius r covers the (2r + 1) x (2r + 1) pixels around a pixel, and a
+ * cross of radius r covers the pixels at most r away in the same row or
+ * the same column. */
+typedef enum {
+    Bit2_SQUARE,
+    Bit2_CROSS
+} Bit2_shape;
+
 /* Bit2_new
  * Purpose: Creates a new Bit2 of a given width and height
  * Parameters: integers representing width and height of the Bit2
@@ -35,6 +47,44 @@ typedef struct T *T;
  */
 T Bit2_new(int width, int height);
 
+/* Bit2_new_pool
+ * Purpose: Creates a new Bit2 whose storage comes from a Pool
+ * Parameters: integers representing width and height of the Bit2, and
+ *             the Pool to allocate from, or NULL for the heap
+ * Returns: the new Bit2
+ * Expected input: a width and height that are both greater than 0, and
+ *                 a valid Pool or NULL
+ * Success output: a new, all-zero Bit2 with the same row layout as
+ *                 Bit2_new; with a NULL Pool this is Bit2_new
+ * Failure output: if the width or height are invalid, a Hanson CRE
+ *                 is raised
+ *           Note: A pooled Bit2 lives until its Pool is reset or freed.
+ *                 Bit2_free on it is allowed and does nothing.
+ */
+T Bit2_new_pool(int width, int height, Pool_T pool);
+
+/* Bit2_wrap
+ * Purpose: Creates a Bit2 whose storage is an existing packed buffer,
+ *          without copying it
+ * Parameters: a pointer to the buffer, integers representing the width
+ *             and height of the Bit2, the number of bytes from the start
+ *             of one row to the start of the next, and an int flag that
+ *             is nonzero if Bit2_free should free the buffer
+ * Returns: the new Bit2
+ * Expected input: a non-null buffer of at least height * stride bytes,
+ *                 a width and height greater than 0, and a stride of at
+ *                 least (width + 7) / 8
+ * Success output: a new Bit2 that reads and writes the buffer in place
+ * Failure output: if the buffer is null or the dimensions or stride are
+ *                 invalid, a Hanson CRE is raised
+ *           Note: Pixel (col, row) is bit 7 - col % 8 of byte
+ *                 row * stride + col / 8, as in P4. An owned buffer must
+ *                 come from malloc. Padding bits after the last column
+ *                 of a row are never read by Bit2_get.
+ */
+T Bit2_wrap(unsigned char *bits, int width, int height, int stride,
+                                                        int owns_bits);
+
 /* Bit2_get
  * Purpose: Get the value stored in target location
  * Parameters: the Bit2 and two ints for the column and row of the
@@ -82,6 +132,62 @@ int Bit2_width(T bit2);
  */
 int Bit2_height(T bit2);
 
+/* Bit2_stride
+ * Purpose: Returns the number of bytes between the starts of two
+ *          consecutive rows of a given Bit2
+ * Parameters: the Bit2
+ * Returns: the row stride of the Bit2 in bytes
+ * Expected input: a valid Bit2
+ * Success output: returns the stride of the Bit2
+ * Failure output: if the Bit2 is null, a Hanson CRE is raised
+ */
+int Bit2_stride(T bit2);
+
+/* Bit2_row
+ * Purpose: Returns a pointer to the packed bytes of one row of a Bit2,
+ *          for zero-copy output such as writing a P4 raster
+ * Parameters: the Bit2 and an int for the target row
+ * Returns: a pointer to the first byte of the row
+ * Expected input: a valid Bit2 and a row within the bounds of the Bit2
+ * Success output: a pointer to (width + 7) / 8 bytes holding the row,
+ *                 most significant bit first, that stays valid until the
+ *                 Bit2 is freed
+ * Failure output: if the Bit2 is null, or if the row is not within the
+ *                 bounds of the Bit2, a Hanson CRE is raised
+ */
+unsigned char *Bit2_row(T bit2, int row);
+
+/* Bit2_put_row
+ * Purpose: Stores a whole row of a Bit2 from packed bytes
+ * Parameters: the Bit2, an int for the target row, and a pointer to the
+ *             packed bytes
+ * Returns: none
+ * Expected input: a valid Bit2, a row within its bounds, and
+ *                 (width + 7) / 8 bytes holding the row most significant
+ *                 bit first, as in a P4 raster
+ * Success output: the row holds the bytes' pixels; padding bits after
+ *                 the last column are cleared
+ * Failure output: if the Bit2 or the bytes are null, or if the row is
+ *                 not within the bounds of the Bit2, a Hanson CRE is
+ *                 raised
+ */
+void Bit2_put_row(T bit2, int row, const unsigned char *bytes);
+
+/* Bit2_get_row
+ * Purpose: Copies a whole row of a Bit2 out as packed bytes
+ * Parameters: the Bit2, an int for the target row, and a pointer to the
+ *             buffer for the packed bytes
+ * Returns: none
+ * Expected input: a valid Bit2, a row within its bounds, and a buffer of
+ *                 at least (width + 7) / 8 bytes
+ * Success output: the buffer holds the row most significant bit first,
+ *                 with the padding bits after the last column cleared
+ * Failure output: if the Bit2 or the buffer are null, or if the row is
+ *                 not within the bounds of the Bit2, a Hanson CRE is
+ *                 raised
+ */
+void Bit2_get_row(T bit2, int row, unsigned char *bytes);
+
 /* Bit2_map_col_major
  * Purpose: Traverse a given Bit2 column by column starting from 
  *             the top left element, calling the apply function on each
@@ -128,9 +234,141 @@ void Bit2_map_col_major(T bit2, void apply(int col, int row, T a,
 void Bit2_map_row_major(T bit2, void apply(int col, int row, T a,
                                         int b, void *p1), void *cl);
 
+/* Bit2_map_parallel
+ * Purpose: Traverse a given Bit2 with a pool of worker threads, each of
+ *             which visits a disjoint band of rows in row-major
+ *             order, calling the apply function on each element with
+ *             its own copy of the closure value, then folding the
+ *             per-thread closures back into the caller's closure
+ * Parameters: the Bit2, the number of worker threads (0 uses one per
+ *             online processor), function pointer to the thread-safe
+ *             function to apply to each element, void pointer to the
+ *             closure value, the size of the closure in bytes, and
+ *             function pointer to the reduce function
+ * Returns: none
+ * Expected input: a valid Bit2, a non-negative thread count, a function
+ *                 pointer with matching apply function parameters, and
+ *                 either a closure of cl_size bytes or a null closure
+ *                 with a cl_size of 0
+ * Success output: none
+ * Failure output: if either the Bit2 or the apply function are null, or
+ *                 if the thread count is negative, a Hanson CRE is raised
+ *           Note: When cl_size is nonzero, every worker starts from a
+ *                 byte copy of *cl, and after all workers finish, reduce
+ *                 is called once per worker, in band order, on the
+ *                 calling thread with cl and that worker's copy. A null
+ *                 reduce discards the copies. When cl_size is 0 all
+ *                 workers share cl and reduce is never called. Workers
+ *                 may Bit2_put only within their own band.
+ */
+void Bit2_map_parallel(T bit2, int num_threads,
+                       void apply(int col, int row, T a, int b, void *p1),
+                       void *cl, size_t cl_size,
+                       void reduce(void *cl, void *thread_cl));
+
+/* Bit2_save
+ * Purpose: Writes a Bit2 to a file in the binary arrayfile format
+ * Parameters: the Bit2 and a file pointer for the output stream
+ * Returns: none
+ * Expected input: a valid Bit2 and a stream open for binary writing
+ * Success output: a 64-byte header followed by the packed rows, padding
+ *                 included, is written with one sequential write
+ * Failure output: if the Bit2 or file pointer is null, or if the write
+ *                 fails, a Hanson CRE is raised
+ */
+void Bit2_save(T bit2, FILE *fp);
+
+/* Bit2_load
+ * Purpose: Reads a Bit2 written by Bit2_save
+ * Parameters: a file pointer for the input stream
+ * Returns: the new Bit2, which owns its storage
+ * Expected input: a stream positioned at the start of a saved Bit2
+ * Success output: a Bit2 with the saved dimensions, stride and bits
+ * Failure output: if the file pointer is null, if the read fails, or if
+ *                 the header or checksum is invalid, a Hanson CRE is
+ *                 raised
+ *           Note: The payload starts at byte sizeof(ArrayFile_header) of
+ *                 the file, so a mapped file can also be passed straight
+ *                 to Bit2_wrap.
+ */
+T Bit2_load(FILE *fp);
+
+/* Bit2_dilate
+ * Purpose: Creates the morphological dilation of a Bit2: a pixel is 1 if
+ *          any pixel under the structuring element centered on it is 1
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ *           Note: All four operators work on 64 pixels per word
+ *                 operation. Pixels outside the Bit2 never count, so
+ *                 dilation treats them as 0 and erosion treats them as 1.
+ */
+T Bit2_dilate(T bit2, Bit2_shape shape, int radius);
+
+/* Bit2_erode
+ * Purpose: Creates the morphological erosion of a Bit2: a pixel is 1 if
+ *          every pixel under the structuring element centered on it is 1
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_erode(T bit2, Bit2_shape shape, int radius);
+
+/* Bit2_open
+ * Purpose: Creates the morphological opening of a Bit2 (erosion followed
+ *          by dilation), which removes black specks smaller than the
+ *          structuring element
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_open(T bit2, Bit2_shape shape, int radius);
+
+/* Bit2_close
+ * Purpose: Creates the morphological closing of a Bit2 (dilation
+ *          followed by erosion), which fills white holes smaller than
+ *          the structuring element
+ * Parameters: the Bit2, the shape of the structuring element, and an int
+ *             for its radius
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2 and a radius that is at least 0
+ * Success output: a new Bit2 with the same dimensions is returned
+ * Failure output: if the Bit2 is null or the radius is negative, a
+ *                 Hanson CRE is raised
+ */
+T Bit2_close(T bit2, Bit2_shape shape, int radius);
+
+/* Bit2_transpose
+ * Purpose: Creates the transpose of a Bit2
+ * Parameters: the Bit2
+ * Returns: the new Bit2
+ * Expected input: a valid Bit2
+ * Success output: a new Bit2 as wide as the original is high and as high
+ *                 as it is wide, whose pixel (row, col) is the original's
+ *                 pixel (col, row)
+ * Failure output: if the Bit2 is null, a Hanson CRE is raised
+ *           Note: The rows are cut into 64 x 64 tiles of 64-bit words,
+ *                 and each tile is transposed in registers with six
+ *                 rounds of masked swaps, a few instructions per word.
+ */
+T Bit2_transpose(T bit2);
+
 /* Bit2_free
  * Purpose: Frees memory associated with a given Bit2, including the
- *          elements stored inside of it.
+ *          elements stored inside of it unless they belong to a buffer
+ *          that was wrapped without ownership.
  * Parameters: a pointer to the Bit2 to free
  * Returns: void
  * Expected input: non-null pointer to a valid Bit2
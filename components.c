@@ -0,0 +1,427 @@
+/**************************************************************
+ *
+ *                     components.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the Components interface. Runs are stored
+ *       in row-major order, so the runs of a row are contiguous and
+ *       sorted by column. During labeling each run's parent field is
+ *       its union-find link; roots are always the earliest run of
+ *       their component, which makes labels follow row-major order.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <components.h>
+
+#define T Components_T
+
+/* A horizontal run of black pixels, columns start to end inclusive */
+typedef struct Run {
+    int row;
+    int start;
+    int end;
+    int parent;
+    int label;
+} Run;
+
+struct T {
+    Run *runs;
+    int num_runs;
+    int *row_first;
+    Components_Stats *stats;
+    int count;
+    int width;
+    int height;
+};
+
+static void add_run(T components, int *capacity, int row, int start,
+                                                           int end);
+static int find_root(Run *runs, int i);
+static void join_runs(Run *runs, int a, int b);
+static int next_bit(unsigned char *bits, int width, int col, int value);
+static void clear_run(unsigned char *bits, int start, int end);
+
+/* Components_label
+ * Purpose: Labels the connected components of the 1 bits of a Bit2
+ * Parameters: the Bit2 and an int for the connectivity, 4 or 8
+ * Returns: the new Components
+ *
+ *       Note: Runs of the previous row are walked with a second index
+ *             that only moves forward, so joining costs O(runs) per row.
+ */
+T Components_label(Bit2_T bitmap, int connectivity)
+{
+    assert (bitmap != NULL);
+    assert (connectivity == 4 || connectivity == 8);
+
+    int slack = connectivity == 8 ? 1 : 0;
+    int capacity = 64;
+
+    T components = malloc(sizeof(struct T));
+    assert (components != NULL);
+
+    components->width = Bit2_width(bitmap);
+    components->height = Bit2_height(bitmap);
+    components->num_runs = 0;
+    components->runs = malloc(capacity * sizeof(Run));
+    components->row_first = malloc((components->height + 1) * sizeof(int));
+    assert (components->runs != NULL && components->row_first != NULL);
+
+    /* Pass 1: find the runs of each row and join overlapping runs */
+    for (int row = 0; row < components->height; row++) {
+        unsigned char *bits = Bit2_row(bitmap, row);
+        int prev = row > 0 ? components->row_first[row - 1] : 0;
+        int prev_end = components->num_runs;
+        int col = 0;
+
+        components->row_first[row] = components->num_runs;
+
+        while ((col = next_bit(bits, components->width, col, 1))
+                                                < components->width) {
+            int end = next_bit(bits, components->width, col, 0) - 1;
+            int curr = components->num_runs;
+
+            add_run(components, &capacity, row, col, end);
+
+            Run *runs = components->runs;
+            while (prev < prev_end && runs[prev].end < col - slack) {
+                prev++;
+            }
+            for (int j = prev; j < prev_end
+                               && runs[j].start <= end + slack; j++) {
+                join_runs(runs, j, curr);
+            }
+
+            col = end + 1;
+        }
+    }
+    components->row_first[components->height] = components->num_runs;
+
+    /* Pass 2: number the roots and gather statistics run by run */
+    int stats_capacity = 16;
+    components->count = 0;
+    components->stats = malloc(stats_capacity * sizeof(Components_Stats));
+    assert (components->stats != NULL);
+
+    for (int i = 0; i < components->num_runs; i++) {
+        Run *run = &components->runs[i];
+        int root = find_root(components->runs, i);
+
+        if (root == i) {
+            if (components->count == stats_capacity) {
+                stats_capacity *= 2;
+                components->stats = realloc(components->stats,
+                                 stats_capacity * sizeof(Components_Stats));
+                assert (components->stats != NULL);
+            }
+
+            Components_Stats *stats = &components->stats[components->count];
+            stats->area = 0;
+            stats->min_col = run->start;
+            stats->max_col = run->end;
+            stats->min_row = run->row;
+            stats->max_row = run->row;
+            stats->touches_border = 0;
+
+            run->label = components->count++;
+        } else {
+            run->label = components->runs[root].label;
+        }
+
+        Components_Stats *stats = &components->stats[run->label];
+        stats->area += run->end - run->start + 1;
+        if (run->start < stats->min_col) {
+            stats->min_col = run->start;
+        }
+        if (run->end > stats->max_col) {
+            stats->max_col = run->end;
+        }
+        stats->max_row = run->row;
+        if (run->row == 0 || run->row == components->height - 1
+                          || run->start == 0
+                          || run->end == components->width - 1) {
+            stats->touches_border = 1;
+        }
+    }
+
+    return components;
+}
+
+/* Components_count
+ * Purpose: Returns the number of components that were found
+ * Parameters: the Components
+ * Returns: the number of components
+ */
+int Components_count(T components)
+{
+    assert (components != NULL);
+
+    return components->count;
+}
+
+/* Components_stats
+ * Purpose: Returns the statistics of one component
+ * Parameters: the Components and an int for the label of the component
+ * Returns: the component's area, bounding box and border flag
+ */
+Components_Stats Components_stats(T components, int label)
+{
+    assert (components != NULL);
+    assert (label >= 0 && label < components->count);
+
+    return components->stats[label];
+}
+
+/* Components_label_at
+ * Purpose: Returns the label of the component holding a pixel
+ * Parameters: the Components and two ints for the column and row
+ * Returns: the pixel's label, or -1 if the pixel is white
+ */
+int Components_label_at(T components, int col, int row)
+{
+    assert (components != NULL);
+    assert (col >= 0 && col < components->width);
+    assert (row >= 0 && row < components->height);
+
+    int lo = components->row_first[row];
+    int hi = components->row_first[row + 1];
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        Run *run = &components->runs[mid];
+
+        if (run->end < col) {
+            lo = mid + 1;
+        } else if (run->start > col) {
+            hi = mid;
+        } else {
+            return run->label;
+        }
+    }
+
+    return -1;
+}
+
+/* Components_remove
+ * Purpose: Clears from a Bit2 every component for which a predicate
+ *          returns nonzero
+ * Parameters: the Components, the labeled Bit2, the predicate, and the
+ *             predicate's closure value
+ * Returns: the number of components that were removed
+ */
+int Components_remove(T components, Bit2_T bitmap,
+                      int remove(Components_Stats *stats, void *cl),
+                      void *cl)
+{
+    assert (components != NULL && bitmap != NULL && remove != NULL);
+    assert (Bit2_width(bitmap) == components->width);
+    assert (Bit2_height(bitmap) == components->height);
+
+    if (components->count == 0) {
+        return 0;
+    }
+
+    char *chosen = malloc(components->count);
+    assert (chosen != NULL);
+
+    int removed = 0;
+    for (int label = 0; label < components->count; label++) {
+        chosen[label] = remove(&components->stats[label], cl) != 0;
+        removed += chosen[label];
+    }
+
+    for (int i = 0; removed > 0 && i < components->num_runs; i++) {
+        Run *run = &components->runs[i];
+
+        if (chosen[run->label]) {
+            clear_run(Bit2_row(bitmap, run->row), run->start, run->end);
+        }
+    }
+
+    free(chosen);
+
+    return removed;
+}
+
+/* Components_touches_border
+ * Purpose: Predicate that chooses components touching the image edge
+ * Parameters: the component's statistics and an unused closure
+ * Returns: nonzero if the component touches the border
+ */
+int Components_touches_border(Components_Stats *stats, void *cl)
+{
+    (void)cl;
+
+    return stats->touches_border;
+}
+
+/* Components_area_below
+ * Purpose: Predicate that chooses components smaller than *(long *)cl
+ * Parameters: the component's statistics and a pointer to a long
+ * Returns: nonzero if the component's area is below the limit
+ */
+int Components_area_below(Components_Stats *stats, void *cl)
+{
+    assert (cl != NULL);
+
+    return stats->area < *(long *)cl;
+}
+
+/* Components_area_above
+ * Purpose: Predicate that chooses components larger than *(long *)cl
+ * Parameters: the component's statistics and a pointer to a long
+ * Returns: nonzero if the component's area is above the limit
+ */
+int Components_area_above(Components_Stats *stats, void *cl)
+{
+    assert (cl != NULL);
+
+    return stats->area > *(long *)cl;
+}
+
+/* Components_free
+ * Purpose: Frees memory associated with a given Components
+ * Parameters: a pointer to the Components to free
+ * Returns: void
+ */
+void Components_free(T *components)
+{
+    assert (components != NULL && *components != NULL);
+
+    free((*components)->runs);
+    free((*components)->row_first);
+    free((*components)->stats);
+    free(*components);
+    *components = NULL;
+}
+
+/* add_run
+ *    Purpose: Appends a run to a Components, growing the run array as
+ *             needed; the run starts out as its own root
+ * Parameters: the Components, a pointer to the run array's capacity, and
+ *             the run's row, first column and last column
+ *    Returns: void
+ */
+static void add_run(T components, int *capacity, int row, int start,
+                                                           int end)
+{
+    if (components->num_runs == *capacity) {
+        *capacity *= 2;
+        components->runs = realloc(components->runs,
+                                   *capacity * sizeof(Run));
+        assert (components->runs != NULL);
+    }
+
+    Run *run = &components->runs[components->num_runs];
+    run->row = row;
+    run->start = start;
+    run->end = end;
+    run->parent = components->num_runs;
+    run->label = -1;
+
+    components->num_runs++;
+}
+
+/* find_root
+ *    Purpose: Finds the root of a run's union-find tree, halving the
+ *             path along the way
+ * Parameters: the run array and the index of the run
+ *    Returns: the index of the root run
+ */
+static int find_root(Run *runs, int i)
+{
+    while (runs[i].parent != i) {
+        runs[i].parent = runs[runs[i].parent].parent;
+        i = runs[i].parent;
+    }
+
+    return i;
+}
+
+/* join_runs
+ *    Purpose: Merges the union-find trees of two runs, keeping the
+ *             earlier root so roots stay in row-major order
+ * Parameters: the run array and the indices of the two runs
+ *    Returns: void
+ */
+static void join_runs(Run *runs, int a, int b)
+{
+    int root_a = find_root(runs, a);
+    int root_b = find_root(runs, b);
+
+    if (root_a < root_b) {
+        runs[root_b].parent = root_a;
+    } else if (root_b < root_a) {
+        runs[root_a].parent = root_b;
+    }
+}
+
+/* next_bit
+ *    Purpose: Finds the first column at or after col whose bit equals value
+ * Parameters: a packed MSB-first row, the row's width, the column to
+ *             start from, and the bit value (0 or 1) to look for
+ *    Returns: that column, or width if there is none
+ *
+ *       Note: 64 pixels at a time are skipped while they are all the
+ *             wrong value, then 8 at a time, then one at a time.
+ */
+static int next_bit(unsigned char *bits, int width, int col, int value)
+{
+    uint64_t skip_word = value == 1 ? 0 : ~(uint64_t)0;
+    unsigned char skip_byte = value == 1 ? 0x00 : 0xFF;
+
+    while (col < width) {
+        if (col % 8 == 0) {
+            uint64_t word;
+
+            if (col + 64 <= width) {
+                memcpy(&word, bits + col / 8, 8);
+                if (word == skip_word) {
+                    col += 64;
+                    continue;
+                }
+            }
+            if (col + 8 <= width && bits[col / 8] == skip_byte) {
+                col += 8;
+                continue;
+            }
+        }
+
+        if (((bits[col / 8] >> (7 - col % 8)) & 1) == value) {
+            return col;
+        }
+        col++;
+    }
+
+    return width;
+}
+
+/* clear_run
+ *    Purpose: Sets columns start through end of a packed row to 0
+ * Parameters: a packed MSB-first row and the first and last column
+ *    Returns: void
+ */
+static void clear_run(unsigned char *bits, int start, int end)
+{
+    int first = start / 8;
+    int last = end / 8;
+    unsigned char head = 0xFF >> (start % 8);
+    unsigned char tail = 0xFF << (7 - end % 8);
+
+    if (first == last) {
+        bits[first] &= ~(head & tail);
+        return;
+    }
+
+    bits[first] &= ~head;
+    memset(bits + first + 1, 0, last - first - 1);
+    bits[last] &= ~tail;
+}
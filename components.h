@@ -0,0 +1,147 @@
+/**************************************************************
+ *
+ *                     components.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The Components interface labels the connected components of
+ *     black (1) pixels in a Bit2 and reports the area, bounding box
+ *     and border contact of each one. Labeling is run-based: one
+ *     pass over the packed rows finds horizontal runs of black
+ *     pixels and joins overlapping runs of neighboring rows with
+ *     union-find, and a second pass over the runs (not the pixels)
+ *     assigns labels and gathers statistics. Filters then clear
+ *     whole components at once, which is how border removal,
+ *     despeckling and blob removal are all done.
+ *
+ **************************************************************/
+
+#ifndef __COMPONENTS__
+#define __COMPONENTS__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <bit2.h>
+#define T Components_T
+
+typedef struct T *T;
+
+/* Statistics of one connected component */
+typedef struct Components_Stats {
+    long area;
+    int min_col;
+    int min_row;
+    int max_col;
+    int max_row;
+    int touches_border;
+} Components_Stats;
+
+/* Components_label
+ * Purpose: Labels the connected components of the 1 bits of a Bit2
+ * Parameters: the Bit2 and an int for the connectivity, 4 (pixels that
+ *             share an edge) or 8 (pixels that share an edge or corner)
+ * Returns: the new Components
+ * Expected input: a valid Bit2 and a connectivity of 4 or 8
+ * Success output: labels 0 to count - 1 are given to the components in
+ *                 the order their first pixel appears in row-major order
+ * Failure output: if the Bit2 is null or the connectivity is not 4 or
+ *                 8, a Hanson CRE is raised
+ *           Note: The Components does not keep a reference to the Bit2.
+ */
+T Components_label(Bit2_T bitmap, int connectivity);
+
+/* Components_count
+ * Purpose: Returns the number of components that were found
+ * Parameters: the Components
+ * Returns: the number of components
+ * Expected input: a valid Components
+ * Success output: the count, which is 0 for an all-white Bit2
+ * Failure output: if the Components is null, a Hanson CRE is raised
+ */
+int Components_count(T components);
+
+/* Components_stats
+ * Purpose: Returns the statistics of one component
+ * Parameters: the Components and an int for the label of the component
+ * Returns: the component's area, bounding box and border flag
+ * Expected input: a valid Components and a label from 0 to count - 1
+ * Success output: the Components_Stats of that component
+ * Failure output: if the Components is null or the label is out of
+ *                 range, a Hanson CRE is raised
+ */
+Components_Stats Components_stats(T components, int label);
+
+/* Components_label_at
+ * Purpose: Returns the label of the component holding a pixel
+ * Parameters: the Components and two ints for the column and row
+ * Returns: the pixel's label, or -1 if the pixel is white
+ * Expected input: a valid Components and a column and row within the
+ *                 bounds of the labeled Bit2
+ * Success output: the label is found by binary search over the row's runs
+ * Failure output: if the Components is null or the column or row is out
+ *                 of bounds, a Hanson CRE is raised
+ */
+int Components_label_at(T components, int col, int row);
+
+/* Components_remove
+ * Purpose: Clears from a Bit2 every component for which a predicate
+ *          returns nonzero
+ * Parameters: the Components, the Bit2 that was labeled, function pointer
+ *             to the predicate, and void pointer to the predicate's
+ *             closure value
+ * Returns: the number of components that were removed
+ * Expected input: a valid Components, the Bit2 it was made from (or one
+ *                 with the same dimensions), and a non-null predicate
+ * Success output: the pixels of the chosen components are set to 0
+ * Failure output: if any pointer is null or the dimensions differ, a
+ *                 Hanson CRE is raised
+ *           Note: The predicate is called once per component with its
+ *                 statistics and the closure. Whole runs are cleared a
+ *                 byte at a time. The Components is unchanged, so several
+ *                 filters can be applied in turn.
+ */
+int Components_remove(T components, Bit2_T bitmap,
+                      int remove(Components_Stats *stats, void *cl),
+                      void *cl);
+
+/* Components_touches_border
+ * Purpose: Predicate for Components_remove that chooses the components
+ *          touching the edge of the image, i.e. black scanning edges
+ * Parameters: the component's statistics and an unused closure
+ * Returns: nonzero if the component touches the border
+ */
+int Components_touches_border(Components_Stats *stats, void *cl);
+
+/* Components_area_below
+ * Purpose: Predicate for Components_remove that chooses components with
+ *          fewer pixels than *(long *)cl, i.e. specks
+ * Parameters: the component's statistics and a pointer to a long
+ * Returns: nonzero if the component's area is below the limit
+ */
+int Components_area_below(Components_Stats *stats, void *cl);
+
+/* Components_area_above
+ * Purpose: Predicate for Components_remove that chooses components with
+ *          more pixels than *(long *)cl, e.g. punch holes
+ * Parameters: the component's statistics and a pointer to a long
+ * Returns: nonzero if the component's area is above the limit
+ */
+int Components_area_above(Components_Stats *stats, void *cl);
+
+/* Components_free
+ * Purpose: Frees memory associated with a given Components
+ * Parameters: a pointer to the Components to free
+ * Returns: void
+ * Expected input: non-null pointer to a valid Components
+ * Success output: none
+ * Failure output: if either the pointer or the Components itself are
+ *                 null, a Hanson CRE is raised
+ */
+void Components_free(T *components);
+
+#undef T
+#endif /* __COMPONENTS__ */
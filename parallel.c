@@ -0,0 +1,212 @@
+/**************************************************************
+ *
+ *                     parallel.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the parallel interface on top of POSIX
+ *       threads. Every call to Parallel_run starts its workers,
+ *       runs them to completion, and joins them before returning,
+ *       so no thread outlives the call that created it.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <parallel.h>
+
+typedef struct WorkerData {
+    void (*work)(int worker, int num_workers, void *cl);
+    int worker;
+    int num_workers;
+    void *cl;
+} WorkerData;
+
+/* Shared state of Parallel_chunks; next is the first unclaimed chunk */
+typedef struct ChunkData {
+    void (*work)(int worker, int chunk, void *cl);
+    int num_chunks;
+    int next;
+    pthread_mutex_t lock;
+    void *cl;
+} ChunkData;
+
+static void *run_worker(void *arg);
+static void claim_chunks(int worker, int num_workers, void *cl);
+
+/* Parallel_default_threads
+ * Purpose: Returns the number of workers to use when a caller asks for
+ *          the default pool size
+ * Parameters: none
+ * Returns: the number of online processors, or 1 if it cannot be found
+ */
+int Parallel_default_threads(void)
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (num_cpus < 1) {
+        return 1;
+    }
+
+    return (int)num_cpus;
+}
+
+/* Parallel_run
+ * Purpose: Calls the work function once on each of num_threads worker
+ *          threads and returns once every call has finished
+ * Parameters: the number of workers (0 means Parallel_default_threads),
+ *             the work function, and the shared closure
+ * Returns: none
+ *
+ *       Note: Worker 0 runs on the calling thread, so a pool of n
+ *             workers only starts n - 1 new threads.
+ */
+void Parallel_run(int num_threads, void work(int worker, int num_workers,
+                                             void *cl), void *cl)
+{
+    assert (work != NULL && num_threads >= 0);
+
+    if (num_threads == 0) {
+        num_threads = Parallel_default_threads();
+    }
+
+    if (num_threads == 1) {
+        work(0, 1, cl);
+        return;
+    }
+
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    WorkerData *workers = malloc(num_threads * sizeof(WorkerData));
+    assert (threads != NULL && workers != NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].work = work;
+        workers[i].worker = i;
+        workers[i].num_workers = num_threads;
+        workers[i].cl = cl;
+    }
+
+    for (int i = 1; i < num_threads; i++) {
+        int err = pthread_create(&threads[i], NULL, run_worker,
+                                                        &workers[i]);
+        assert (err == 0);
+    }
+
+    run_worker(&workers[0]);
+
+    for (int i = 1; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(workers);
+    free(threads);
+}
+
+/* Parallel_chunks
+ * Purpose: Calls the work function once for every chunk index in
+ *          [0, num_chunks), handing chunks to workers as they free up
+ * Parameters: the number of workers (0 means Parallel_default_threads),
+ *             the number of chunks, the work function, and the shared
+ *             closure
+ * Returns: none
+ *
+ *       Note: Workers claim the next chunk under a mutex, so a worker
+ *             that draws cheap chunks simply claims more of them.
+ */
+void Parallel_chunks(int num_threads, int num_chunks,
+                     void work(int worker, int chunk, void *cl), void *cl)
+{
+    assert (work != NULL && num_threads >= 0 && num_chunks >= 0);
+
+    if (num_threads == 0) {
+        num_threads = Parallel_default_threads();
+    }
+    if (num_threads > num_chunks) {
+        num_threads = num_chunks;
+    }
+    if (num_chunks == 0) {
+        return;
+    }
+
+    ChunkData data;
+    data.work = work;
+    data.num_chunks = num_chunks;
+    data.next = 0;
+    data.cl = cl;
+
+    int err = pthread_mutex_init(&data.lock, NULL);
+    assert (err == 0);
+
+    Parallel_run(num_threads, claim_chunks, &data);
+
+    pthread_mutex_destroy(&data.lock);
+}
+
+/* Parallel_band
+ * Purpose: Splits the range [0, length) into num_workers contiguous,
+ *          disjoint bands of nearly equal size and reports one of them
+ * Parameters: the length of the range, the number of bands, the index of
+ *             the target band, and pointers for the band's bounds
+ * Returns: none
+ *
+ *       Note: The first length % num_workers bands are one longer than
+ *             the rest, so band sizes never differ by more than one.
+ */
+void Parallel_band(int length, int num_workers, int worker, int *lo,
+                                                            int *hi)
+{
+    assert (length >= 0 && num_workers > 0);
+    assert (worker >= 0 && worker < num_workers);
+    assert (lo != NULL && hi != NULL);
+
+    int base = length / num_workers;
+    int extra = length % num_workers;
+
+    *lo = worker * base + (worker < extra ? worker : extra);
+    *hi = *lo + base + (worker < extra ? 1 : 0);
+}
+
+/* run_worker
+ *    Purpose: pthread entry point that unpacks a WorkerData and calls
+ *             its work function
+ * Parameters: a void pointer to the worker's WorkerData
+ *    Returns: NULL
+ */
+static void *run_worker(void *arg)
+{
+    WorkerData *data = arg;
+
+    data->work(data->worker, data->num_workers, data->cl);
+
+    return NULL;
+}
+
+/* claim_chunks
+ *    Purpose: Worker body for Parallel_chunks; claims chunk indices one
+ *             at a time until none are left
+ * Parameters: the worker index, the number of workers, and a void
+ *             pointer to the shared ChunkData
+ *    Returns: void
+ */
+static void claim_chunks(int worker, int num_workers, void *cl)
+{
+    ChunkData *data = cl;
+    (void)num_workers;
+
+    for (;;) {
+        pthread_mutex_lock(&data->lock);
+        int chunk = data->next++;
+        pthread_mutex_unlock(&data->lock);
+
+        if (chunk >= data->num_chunks) {
+            return;
+        }
+
+        data->work(worker, chunk, data->cl);
+    }
+}
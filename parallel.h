@@ -0,0 +1,96 @@
+/**************************************************************
+ *
+ *                     parallel.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The parallel interface runs a piece of work on a group of
+ *     POSIX worker threads and waits for all of them to finish.
+ *     It is the shared threading layer underneath the parallel
+ *     map functions of the Bit2 and UArray2 interfaces. Work is
+ *     split either into one fixed band per worker or into chunks
+ *     that workers claim dynamically.
+ *
+ **************************************************************/
+
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/* Parallel_default_threads
+ * Purpose: Returns the number of workers to use when a caller asks for
+ *          the default pool size
+ * Parameters: none
+ * Returns: the number of online processors, or 1 if it cannot be found
+ * Expected input: none
+ * Success output: an integer that is at least 1
+ * Failure output: none
+ */
+int Parallel_default_threads(void);
+
+/* Parallel_run
+ * Purpose: Calls the work function once on each of num_threads worker
+ *          threads and returns once every call has finished
+ * Parameters: the number of workers (0 means Parallel_default_threads),
+ *             a function pointer to the work each worker does, and a
+ *             void pointer to the closure shared by all workers
+ * Returns: none
+ * Expected input: a non-negative worker count and a non-null work
+ *                 function that is safe to run concurrently
+ * Success output: none
+ * Failure output: if the work function is null, the worker count is
+ *                 negative, or a thread cannot be started, a Hanson CRE
+ *                 is raised
+ *           Note: The work function parameters are the index of the
+ *                 current worker, the total number of workers, and the
+ *                 shared closure. With a single worker the work function
+ *                 runs on the calling thread.
+ */
+void Parallel_run(int num_threads, void work(int worker, int num_workers,
+                                             void *cl), void *cl);
+
+/* Parallel_chunks
+ * Purpose: Calls the work function once for every chunk index in
+ *          [0, num_chunks), handing the next unclaimed chunk to
+ *          whichever worker finishes first
+ * Parameters: the number of workers (0 means Parallel_default_threads),
+ *             the number of chunks, a function pointer to the work done
+ *             for one chunk, and a void pointer to the shared closure
+ * Returns: none
+ * Expected input: non-negative worker and chunk counts and a non-null
+ *                 work function that is safe to run concurrently
+ * Success output: none
+ * Failure output: if the work function is null, a count is negative, or
+ *                 a thread cannot be started, a Hanson CRE is raised
+ *           Note: The work function parameters are the index of the
+ *                 worker running the chunk, the chunk index, and the
+ *                 shared closure. Which worker runs which chunk varies
+ *                 from run to run; callers that need deterministic
+ *                 results should keep per-chunk, not per-worker, state.
+ */
+void Parallel_chunks(int num_threads, int num_chunks,
+                     void work(int worker, int chunk, void *cl), void *cl);
+
+/* Parallel_band
+ * Purpose: Splits the range [0, length) into num_workers contiguous,
+ *          disjoint bands of nearly equal size and reports one of them
+ * Parameters: the length of the range, the number of bands, the index of
+ *             the target band, and two int pointers that receive the
+ *             first index of the band and one past its last index
+ * Returns: none
+ * Expected input: a non-negative length, at least one band, a band index
+ *                 within range, and non-null output pointers
+ * Success output: *lo and *hi are set; the band may be empty
+ * Failure output: if any of the expected inputs are invalid, a Hanson
+ *                 CRE is raised
+ */
+void Parallel_band(int length, int num_workers, int worker, int *lo,
+                                                            int *hi);
+
+#endif /* __PARALLEL__ */
@@ -0,0 +1,156 @@
+/**************************************************************
+ *
+ *                     pool.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the Pool interface. Chunks form a linked
+ *       list in the order they were first needed. Allocation bumps
+ *       avail within the current chunk and moves on down the list
+ *       when it is full; Pool_reset just moves back to the front.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pool.h>
+
+#define T Pool_T
+
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+
+/* A chunk header; the chunk's bytes follow it */
+typedef struct Chunk {
+    struct Chunk *next;
+    size_t size;
+} Chunk;
+
+struct T {
+    Chunk *first;
+    Chunk *current;
+    char *avail;
+    char *limit;
+    size_t chunk_size;
+};
+
+static void next_chunk(T pool, size_t need);
+
+/* Pool_new
+ * Purpose: Creates a new, empty Pool
+ * Parameters: the chunk size in bytes, or 0 for the default
+ * Returns: the new Pool
+ */
+T Pool_new(size_t chunk_size)
+{
+    T pool = malloc(sizeof(struct T));
+    assert (pool != NULL);
+
+    pool->first = NULL;
+    pool->current = NULL;
+    pool->avail = NULL;
+    pool->limit = NULL;
+    pool->chunk_size = chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE;
+
+    return pool;
+}
+
+/* Pool_alloc
+ * Purpose: Hands out a block of memory from a Pool
+ * Parameters: the Pool, the number of bytes, and the alignment
+ * Returns: a pointer to the block
+ */
+void *Pool_alloc(T pool, size_t nbytes, size_t align)
+{
+    assert (pool != NULL);
+    assert (align > 0 && (align & (align - 1)) == 0);
+    assert (nbytes <= SIZE_MAX - align - sizeof(Chunk));
+
+    uintptr_t mask = align - 1;
+    uintptr_t first = ((uintptr_t)pool->avail + mask) & ~mask;
+
+    if (pool->avail == NULL || first > (uintptr_t)pool->limit
+                            || (uintptr_t)pool->limit - first < nbytes) {
+        next_chunk(pool, nbytes + align - 1);
+        first = ((uintptr_t)pool->avail + mask) & ~mask;
+    }
+
+    pool->avail = (char *)first + nbytes;
+
+    return (void *)first;
+}
+
+/* Pool_reset
+ * Purpose: Releases every block of a Pool at once, keeping the chunks
+ * Parameters: the Pool
+ * Returns: none
+ */
+void Pool_reset(T pool)
+{
+    assert (pool != NULL);
+
+    pool->current = NULL;
+    pool->avail = NULL;
+    pool->limit = NULL;
+}
+
+/* Pool_free
+ * Purpose: Frees a Pool and every chunk it has allocated
+ * Parameters: a pointer to the Pool
+ * Returns: none
+ */
+void Pool_free(T *pool)
+{
+    assert (pool != NULL && *pool != NULL);
+
+    Chunk *chunk = (*pool)->first;
+    while (chunk != NULL) {
+        Chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(*pool);
+    *pool = NULL;
+}
+
+/* next_chunk
+ *    Purpose: Makes the next chunk with room for need bytes current,
+ *             reusing a chunk from before the last reset if one is big
+ *             enough and allocating a new one after the current chunk
+ *             otherwise
+ * Parameters: the Pool and the number of bytes needed
+ *    Returns: void
+ */
+static void next_chunk(T pool, size_t need)
+{
+    Chunk *chunk = pool->current != NULL ? pool->current->next
+                                         : pool->first;
+
+    while (chunk != NULL && chunk->size < need) {
+        chunk = chunk->next;
+    }
+
+    if (chunk == NULL) {
+        size_t size = need > pool->chunk_size ? need : pool->chunk_size;
+
+        chunk = malloc(sizeof(Chunk) + size);
+        assert (chunk != NULL);
+        chunk->size = size;
+
+        if (pool->current != NULL) {
+            chunk->next = pool->current->next;
+            pool->current->next = chunk;
+        } else {
+            chunk->next = pool->first;
+            pool->first = chunk;
+        }
+    }
+
+    pool->current = chunk;
+    pool->avail = (char *)(chunk + 1);
+    pool->limit = pool->avail + chunk->size;
+}
@@ -0,0 +1,84 @@
+/**************************************************************
+ *
+ *                     pool.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The Pool interface is a bump allocator for short-lived
+ *     objects. Memory is handed out from large chunks by moving a
+ *     pointer, nothing is freed one object at a time, and
+ *     Pool_reset releases everything at once while keeping the
+ *     chunks for the next item, so a program that processes many
+ *     items stops calling malloc and free once it is warmed up.
+ *     UArray2_new_pool and Bit2_new_pool build arrays in a Pool.
+ *
+ *     Hanson's Arena is not used because its free list is a global
+ *     shared by every arena, so one arena per thread is unsafe;
+ *     different Pools share nothing.
+ *
+ **************************************************************/
+
+#ifndef __POOL__
+#define __POOL__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#define T Pool_T
+
+typedef struct T *T;
+
+/* Pool_new
+ * Purpose: Creates a new, empty Pool
+ * Parameters: a size_t for the size of each chunk in bytes, or 0 for the
+ *             default of 64 KB
+ * Returns: the new Pool
+ * Expected input: any chunk size
+ * Success output: a Pool that has not yet allocated any chunks
+ * Failure output: if memory cannot be allocated, a Hanson CRE is raised
+ */
+T Pool_new(size_t chunk_size);
+
+/* Pool_alloc
+ * Purpose: Hands out a block of memory from a Pool
+ * Parameters: the Pool, a size_t for the number of bytes, and a size_t
+ *             for the alignment of the block
+ * Returns: a pointer to the block
+ * Expected input: a valid Pool and an alignment that is a power of two
+ * Success output: a block of nbytes bytes at a multiple of align; its
+ *                 contents are unspecified
+ * Failure output: if the Pool is null, the alignment is not a power of
+ *                 two, or memory cannot be allocated, a Hanson CRE is
+ *                 raised
+ *           Note: Blocks larger than a chunk get a chunk of their own.
+ *                 A block stays valid until the next Pool_reset or
+ *                 Pool_free.
+ */
+void *Pool_alloc(T pool, size_t nbytes, size_t align);
+
+/* Pool_reset
+ * Purpose: Releases every block of a Pool at once
+ * Parameters: the Pool
+ * Returns: none
+ * Expected input: a valid Pool
+ * Success output: the chunks are kept and reused by later Pool_allocs
+ * Failure output: if the Pool is null, a Hanson CRE is raised
+ */
+void Pool_reset(T pool);
+
+/* Pool_free
+ * Purpose: Frees a Pool and every chunk it has allocated
+ * Parameters: a pointer to the Pool
+ * Returns: none
+ * Expected input: non-null pointer to a valid Pool
+ * Success output: the Pool is set to NULL
+ * Failure output: if either the pointer or the Pool itself are null, a
+ *                 Hanson CRE is raised
+ */
+void Pool_free(T *pool);
+
+#undef T
+#endif /* __POOL__ */
@@ -0,0 +1,764 @@
+/**************************************************************
+ *
+ *                     sparse2.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the Sparse2 interface. Pixel (col, row)
+ *       has index row * width + col; index i lives in block
+ *       i / 65536 at position i % 65536. Every block keeps a count
+ *       of its set bits and is re-encoded whenever that count
+ *       crosses one of the thresholds below:
+ *
+ *         card == 0            empty (no storage)
+ *         card == block length full (no storage)
+ *         card <= 4096         sorted array of 16-bit positions
+ *         otherwise            1024 words, bit p is bit p % 64 of
+ *                              word p / 64
+ *
+ *       4096 positions take the same 8 KB as a dense block, so no
+ *       block is ever stored in more than 8 KB.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sparse2.h>
+
+#define T Sparse2_T
+
+#define BLOCK_BITS 65536
+#define BLOCK_WORDS (BLOCK_BITS / 64)
+#define ARRAY_MAX 4096
+
+typedef enum {
+    BLOCK_EMPTY = 0,
+    BLOCK_FULL,
+    BLOCK_ARRAY,
+    BLOCK_DENSE
+} BlockKind;
+
+typedef struct Block {
+    BlockKind kind;
+    int card;
+    int capacity;
+    uint16_t *positions;
+    uint64_t *words;
+} Block;
+
+struct T {
+    Block *blocks;
+    int num_blocks;
+    int width;
+    int height;
+    uint64_t size;
+};
+
+/* Closure used by Sparse2_to_bit2 */
+typedef struct CopyData {
+    Bit2_T bit2;
+} CopyData;
+
+static int block_length(T sparse2, int block);
+static void release_block(Block *block);
+static void copy_block(Block *src, Block *dst);
+static int block_get(Block *block, int pos);
+static int array_lower_bound(Block *block, int pos);
+static void block_to_words(Block *block, uint64_t *words, int length);
+static void words_to_block(uint64_t *words, Block *block, int length);
+static void normalize_block(Block *block, int length);
+static void union_block(Block *a, Block *b, Block *result, int length,
+                                                       uint64_t *scratch);
+static void inter_block(Block *a, Block *b, Block *result, int length,
+                                                       uint64_t *scratch);
+static void put_in_bit2(int col, int row, T a, void *p1);
+
+/* Sparse2_new
+ * Purpose: Creates a new, all-zero Sparse2 of a given width and height
+ * Parameters: integers representing width and height of the Sparse2
+ * Returns: the new Sparse2
+ * Expected input: a width and height that are both greater than 0
+ * Success output: a new Sparse2 with no set bits is returned
+ * Failure output: if the width or height are invalid, a Hanson CRE
+ *                 is raised
+ */
+T Sparse2_new(int width, int height)
+{
+    assert (width > 0 && height > 0);
+
+    T new_sparse2 = malloc(sizeof(struct T));
+    assert (new_sparse2 != NULL);
+
+    new_sparse2->width = width;
+    new_sparse2->height = height;
+    new_sparse2->size = (uint64_t)width * height;
+    new_sparse2->num_blocks = (new_sparse2->size + BLOCK_BITS - 1)
+                                                          / BLOCK_BITS;
+
+    /* calloc leaves every block as BLOCK_EMPTY */
+    new_sparse2->blocks = calloc(new_sparse2->num_blocks, sizeof(Block));
+    assert (new_sparse2->blocks != NULL);
+
+    return new_sparse2;
+}
+
+/* Sparse2_from_bit2
+ * Purpose: Creates a Sparse2 holding the same bits as a Bit2
+ * Parameters: the Bit2
+ * Returns: the new Sparse2
+ *
+ *       Note: Each block is assembled in a dense scratch buffer and then
+ *             encoded once, and all-zero runs of 64 pixels in the Bit2
+ *             are skipped with a single comparison.
+ */
+T Sparse2_from_bit2(Bit2_T bit2)
+{
+    assert (bit2 != NULL);
+
+    int width = Bit2_width(bit2);
+    int height = Bit2_height(bit2);
+    int row_bytes = (width + 7) / 8;
+    unsigned char last_mask = 0xFF << ((8 - width % 8) % 8);
+
+    T sparse2 = Sparse2_new(width, height);
+    uint64_t *scratch = calloc(BLOCK_WORDS, sizeof(uint64_t));
+    assert (scratch != NULL);
+    int curr_block = -1;
+
+    for (int row = 0; row < height; row++) {
+        unsigned char *bit_row = Bit2_row(bit2, row);
+        uint64_t base = (uint64_t)row * width;
+
+        for (int i = 0; i < row_bytes; i++) {
+            uint64_t chunk;
+            if (i + 8 <= row_bytes - 1) {
+                memcpy(&chunk, bit_row + i, 8);
+                if (chunk == 0) {
+                    i += 7;
+                    continue;
+                }
+            }
+
+            unsigned byte = bit_row[i];
+            if (i == row_bytes - 1) {
+                byte &= last_mask;
+            }
+
+            while (byte != 0) {
+                int bit = __builtin_clz(byte) - (int)(8 * sizeof(unsigned)
+                                                                      - 8);
+                byte &= ~(0x80u >> bit);
+
+                uint64_t index = base + i * 8 + bit;
+                int block = index / BLOCK_BITS;
+                int pos = index % BLOCK_BITS;
+
+                if (block != curr_block) {
+                    if (curr_block >= 0) {
+                        words_to_block(scratch, &sparse2->blocks[curr_block],
+                                       block_length(sparse2, curr_block));
+                        memset(scratch, 0, BLOCK_WORDS * sizeof(uint64_t));
+                    }
+                    curr_block = block;
+                }
+                scratch[pos / 64] |= (uint64_t)1 << (pos % 64);
+            }
+        }
+    }
+
+    if (curr_block >= 0) {
+        words_to_block(scratch, &sparse2->blocks[curr_block],
+                       block_length(sparse2, curr_block));
+    }
+
+    free(scratch);
+
+    return sparse2;
+}
+
+/* Sparse2_to_bit2
+ * Purpose: Creates a Bit2 holding the same bits as a Sparse2
+ * Parameters: the Sparse2
+ * Returns: the new Bit2
+ */
+Bit2_T Sparse2_to_bit2(T sparse2)
+{
+    assert (sparse2 != NULL);
+
+    CopyData data = { Bit2_new(sparse2->width, sparse2->height) };
+    Sparse2_map_set(sparse2, put_in_bit2, &data);
+
+    return data.bit2;
+}
+
+/* Sparse2_get
+ * Purpose: Get the value stored in target location
+ * Parameters: the Sparse2 and two ints for the column and row of the
+ *             target bit
+ * Returns: an int representing the target bit's stored value
+ */
+int Sparse2_get(T sparse2, int col, int row)
+{
+    assert (sparse2 != NULL);
+    assert (col < sparse2->width && col >= 0);
+    assert (row < sparse2->height && row >= 0);
+
+    uint64_t index = (uint64_t)row * sparse2->width + col;
+
+    return block_get(&sparse2->blocks[index / BLOCK_BITS],
+                                      index % BLOCK_BITS);
+}
+
+/* Sparse2_put
+ * Purpose: Store value in target location in a Sparse2
+ * Parameters: the Sparse2 and two ints for the column and row of where
+ *             new bit will be placed, as well as the new bit value
+ * Returns: the previous value stored in the target location
+ */
+int Sparse2_put(T sparse2, int col, int row, int value)
+{
+    assert (sparse2 != NULL);
+    assert (col < sparse2->width && col >= 0);
+    assert (row < sparse2->height && row >= 0);
+    assert (value == 0 || value == 1);
+
+    uint64_t index = (uint64_t)row * sparse2->width + col;
+    int block_index = index / BLOCK_BITS;
+    int pos = index % BLOCK_BITS;
+    int length = block_length(sparse2, block_index);
+    Block *block = &sparse2->blocks[block_index];
+
+    int prev = block_get(block, pos);
+    if (prev == value) {
+        return prev;
+    }
+
+    if (block->kind == BLOCK_FULL) {
+        block->words = malloc(BLOCK_WORDS * sizeof(uint64_t));
+        assert (block->words != NULL);
+        block_to_words(block, block->words, length);
+        block->kind = BLOCK_DENSE;
+    } else if (block->kind == BLOCK_EMPTY) {
+        block->kind = BLOCK_ARRAY;
+    }
+
+    if (block->kind == BLOCK_DENSE) {
+        block->words[pos / 64] ^= (uint64_t)1 << (pos % 64);
+    } else {
+        int i = array_lower_bound(block, pos);
+
+        if (value == 1) {
+            if (block->card == block->capacity) {
+                block->capacity = block->capacity == 0 ? 4
+                                                : 2 * block->capacity;
+                block->positions = realloc(block->positions,
+                                   block->capacity * sizeof(uint16_t));
+                assert (block->positions != NULL);
+            }
+            memmove(&block->positions[i + 1], &block->positions[i],
+                    (block->card - i) * sizeof(uint16_t));
+            block->positions[i] = pos;
+        } else {
+            memmove(&block->positions[i], &block->positions[i + 1],
+                    (block->card - i - 1) * sizeof(uint16_t));
+        }
+    }
+
+    block->card += value == 1 ? 1 : -1;
+    normalize_block(block, length);
+
+    return prev;
+}
+
+/* Sparse2_width
+ * Purpose: Returns the width of a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the width of the Sparse2 as an integer
+ */
+int Sparse2_width(T sparse2)
+{
+    assert (sparse2 != NULL);
+
+    return sparse2->width;
+}
+
+/* Sparse2_height
+ * Purpose: Returns the height of a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the height of the Sparse2 as an integer
+ */
+int Sparse2_height(T sparse2)
+{
+    assert (sparse2 != NULL);
+
+    return sparse2->height;
+}
+
+/* Sparse2_count
+ * Purpose: Returns the number of set bits in a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the number of bits that are 1
+ */
+long Sparse2_count(T sparse2)
+{
+    assert (sparse2 != NULL);
+
+    long count = 0;
+    for (int i = 0; i < sparse2->num_blocks; i++) {
+        count += sparse2->blocks[i].card;
+    }
+
+    return count;
+}
+
+/* Sparse2_memory
+ * Purpose: Returns the number of bytes of heap memory a Sparse2 uses
+ * Parameters: the Sparse2
+ * Returns: the size of the Sparse2's struct, block table and containers
+ */
+size_t Sparse2_memory(T sparse2)
+{
+    assert (sparse2 != NULL);
+
+    size_t bytes = sizeof(struct T) + sparse2->num_blocks * sizeof(Block);
+
+    for (int i = 0; i < sparse2->num_blocks; i++) {
+        Block *block = &sparse2->blocks[i];
+
+        if (block->kind == BLOCK_ARRAY) {
+            bytes += block->capacity * sizeof(uint16_t);
+        } else if (block->kind == BLOCK_DENSE) {
+            bytes += BLOCK_WORDS * sizeof(uint64_t);
+        }
+    }
+
+    return bytes;
+}
+
+/* Sparse2_map_set
+ * Purpose: Visit every set bit of a given Sparse2 in row-major order,
+ *             calling the apply function on each
+ * Parameters: the Sparse2, the apply function, and the closure value
+ * Returns: none
+ */
+void Sparse2_map_set(T sparse2, void apply(int col, int row, T a,
+                                           void *p1), void *cl)
+{
+    assert (sparse2 != NULL && apply != NULL);
+
+    int width = sparse2->width;
+
+    for (int i = 0; i < sparse2->num_blocks; i++) {
+        Block *block = &sparse2->blocks[i];
+        uint64_t base = (uint64_t)i * BLOCK_BITS;
+        uint64_t index;
+
+        switch (block->kind) {
+        case BLOCK_EMPTY:
+            break;
+        case BLOCK_FULL:
+            for (int pos = 0; pos < block->card; pos++) {
+                index = base + pos;
+                apply(index % width, index / width, sparse2, cl);
+            }
+            break;
+        case BLOCK_ARRAY:
+            for (int j = 0; j < block->card; j++) {
+                index = base + block->positions[j];
+                apply(index % width, index / width, sparse2, cl);
+            }
+            break;
+        case BLOCK_DENSE:
+            for (int w = 0; w < BLOCK_WORDS; w++) {
+                uint64_t word = block->words[w];
+
+                while (word != 0) {
+                    index = base + w * 64 + __builtin_ctzll(word);
+                    apply(index % width, index / width, sparse2, cl);
+                    word &= word - 1;
+                }
+            }
+            break;
+        }
+    }
+}
+
+/* Sparse2_union
+ * Purpose: Creates a Sparse2 that is the bitwise or of two others
+ * Parameters: the two Sparse2s
+ * Returns: the new Sparse2
+ */
+T Sparse2_union(T s, T t)
+{
+    assert (s != NULL && t != NULL);
+    assert (s->width == t->width && s->height == t->height);
+
+    T result = Sparse2_new(s->width, s->height);
+    uint64_t *scratch = malloc(BLOCK_WORDS * sizeof(uint64_t));
+    assert (scratch != NULL);
+
+    for (int i = 0; i < s->num_blocks; i++) {
+        union_block(&s->blocks[i], &t->blocks[i], &result->blocks[i],
+                    block_length(s, i), scratch);
+    }
+
+    free(scratch);
+
+    return result;
+}
+
+/* Sparse2_inter
+ * Purpose: Creates a Sparse2 that is the bitwise and of two others
+ * Parameters: the two Sparse2s
+ * Returns: the new Sparse2
+ */
+T Sparse2_inter(T s, T t)
+{
+    assert (s != NULL && t != NULL);
+    assert (s->width == t->width && s->height == t->height);
+
+    T result = Sparse2_new(s->width, s->height);
+    uint64_t *scratch = malloc(BLOCK_WORDS * sizeof(uint64_t));
+    assert (scratch != NULL);
+
+    for (int i = 0; i < s->num_blocks; i++) {
+        inter_block(&s->blocks[i], &t->blocks[i], &result->blocks[i],
+                    block_length(s, i), scratch);
+    }
+
+    free(scratch);
+
+    return result;
+}
+
+/* Sparse2_free
+ * Purpose: Frees memory associated with a given Sparse2, including all
+ *          of its blocks.
+ * Parameters: a pointer to the Sparse2 to free
+ * Returns: void
+ */
+void Sparse2_free(T *sparse2)
+{
+    assert (sparse2 != NULL && *sparse2 != NULL);
+
+    for (int i = 0; i < (*sparse2)->num_blocks; i++) {
+        release_block(&(*sparse2)->blocks[i]);
+    }
+
+    free((*sparse2)->blocks);
+    free(*sparse2);
+    *sparse2 = NULL;
+}
+
+/* block_length
+ *    Purpose: Returns how many pixels a block covers; only the last
+ *             block of a Sparse2 can be shorter than BLOCK_BITS
+ * Parameters: the Sparse2 and the index of the block
+ *    Returns: the block's length in bits
+ */
+static int block_length(T sparse2, int block)
+{
+    uint64_t remaining = sparse2->size - (uint64_t)block * BLOCK_BITS;
+
+    return remaining < BLOCK_BITS ? (int)remaining : BLOCK_BITS;
+}
+
+/* release_block
+ *    Purpose: Frees a block's container and makes it empty
+ * Parameters: a pointer to the block
+ *    Returns: void
+ */
+static void release_block(Block *block)
+{
+    free(block->positions);
+    free(block->words);
+    block->positions = NULL;
+    block->words = NULL;
+    block->capacity = 0;
+    block->card = 0;
+    block->kind = BLOCK_EMPTY;
+}
+
+/* copy_block
+ *    Purpose: Makes an empty block a deep copy of another block
+ * Parameters: the block to copy and a pointer to the empty destination
+ *    Returns: void
+ */
+static void copy_block(Block *src, Block *dst)
+{
+    *dst = *src;
+
+    if (src->kind == BLOCK_ARRAY) {
+        dst->capacity = src->card;
+        dst->positions = malloc(src->card * sizeof(uint16_t));
+        assert (dst->positions != NULL);
+        memcpy(dst->positions, src->positions, src->card * sizeof(uint16_t));
+    } else if (src->kind == BLOCK_DENSE) {
+        dst->words = malloc(BLOCK_WORDS * sizeof(uint64_t));
+        assert (dst->words != NULL);
+        memcpy(dst->words, src->words, BLOCK_WORDS * sizeof(uint64_t));
+    }
+}
+
+/* block_get
+ *    Purpose: Returns the bit at a position within a block
+ * Parameters: a pointer to the block and the position
+ *    Returns: 0 or 1
+ */
+static int block_get(Block *block, int pos)
+{
+    switch (block->kind) {
+    case BLOCK_FULL:
+        return 1;
+    case BLOCK_ARRAY: {
+        int i = array_lower_bound(block, pos);
+        return i < block->card && block->positions[i] == pos;
+    }
+    case BLOCK_DENSE:
+        return (block->words[pos / 64] >> (pos % 64)) & 1;
+    default:
+        return 0;
+    }
+}
+
+/* array_lower_bound
+ *    Purpose: Binary search for the first stored position that is not
+ *             less than pos in an array block
+ * Parameters: a pointer to the array block and the position
+ *    Returns: the index of that position, or card if there is none
+ */
+static int array_lower_bound(Block *block, int pos)
+{
+    int lo = 0;
+    int hi = block->card;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (block->positions[mid] < pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* block_to_words
+ *    Purpose: Expands any block into a dense array of words
+ * Parameters: a pointer to the block, the BLOCK_WORDS-long output array,
+ *             and the block's length in bits
+ *    Returns: void
+ */
+static void block_to_words(Block *block, uint64_t *words, int length)
+{
+    switch (block->kind) {
+    case BLOCK_DENSE:
+        memcpy(words, block->words, BLOCK_WORDS * sizeof(uint64_t));
+        break;
+    case BLOCK_ARRAY:
+        memset(words, 0, BLOCK_WORDS * sizeof(uint64_t));
+        for (int i = 0; i < block->card; i++) {
+            int pos = block->positions[i];
+            words[pos / 64] |= (uint64_t)1 << (pos % 64);
+        }
+        break;
+    case BLOCK_FULL:
+        memset(words, 0, BLOCK_WORDS * sizeof(uint64_t));
+        memset(words, 0xFF, length / 64 * sizeof(uint64_t));
+        if (length % 64 != 0) {
+            words[length / 64] = ((uint64_t)1 << (length % 64)) - 1;
+        }
+        break;
+    default:
+        memset(words, 0, BLOCK_WORDS * sizeof(uint64_t));
+        break;
+    }
+}
+
+/* words_to_block
+ *    Purpose: Encodes a dense array of words into an empty block using
+ *             the smallest representation for its cardinality
+ * Parameters: the BLOCK_WORDS-long input array, a pointer to the empty
+ *             block, and the block's length in bits
+ *    Returns: void
+ */
+static void words_to_block(uint64_t *words, Block *block, int length)
+{
+    int card = 0;
+    for (int w = 0; w < BLOCK_WORDS; w++) {
+        card += __builtin_popcountll(words[w]);
+    }
+
+    block->card = card;
+
+    if (card == 0) {
+        block->kind = BLOCK_EMPTY;
+    } else if (card == length) {
+        block->kind = BLOCK_FULL;
+    } else if (card <= ARRAY_MAX) {
+        block->kind = BLOCK_ARRAY;
+        block->capacity = card;
+        block->positions = malloc(card * sizeof(uint16_t));
+        assert (block->positions != NULL);
+
+        int i = 0;
+        for (int w = 0; w < BLOCK_WORDS; w++) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                block->positions[i++] = w * 64 + __builtin_ctzll(word);
+            }
+        }
+    } else {
+        block->kind = BLOCK_DENSE;
+        block->words = malloc(BLOCK_WORDS * sizeof(uint64_t));
+        assert (block->words != NULL);
+        memcpy(block->words, words, BLOCK_WORDS * sizeof(uint64_t));
+    }
+}
+
+/* normalize_block
+ *    Purpose: Re-encodes a block whose cardinality has crossed one of
+ *             the representation thresholds
+ * Parameters: a pointer to the block and the block's length in bits
+ *    Returns: void
+ */
+static void normalize_block(Block *block, int length)
+{
+    int needs_array = block->card > 0 && block->card < length
+                                      && block->card <= ARRAY_MAX;
+    int needs_dense = block->card > ARRAY_MAX && block->card < length;
+
+    if (block->card == 0 || block->card == length
+                         || (block->kind == BLOCK_ARRAY && needs_dense)
+                         || (block->kind == BLOCK_DENSE && needs_array)) {
+        uint64_t words[BLOCK_WORDS];
+
+        block_to_words(block, words, length);
+        release_block(block);
+        words_to_block(words, block, length);
+    }
+}
+
+/* union_block
+ *    Purpose: Computes the bitwise or of two blocks into an empty block
+ * Parameters: pointers to the two input blocks and the empty result, the
+ *             block length, and a BLOCK_WORDS-long scratch array
+ *    Returns: void
+ */
+static void union_block(Block *a, Block *b, Block *result, int length,
+                                                       uint64_t *scratch)
+{
+    if (a->kind == BLOCK_EMPTY) {
+        copy_block(b, result);
+    } else if (b->kind == BLOCK_EMPTY) {
+        copy_block(a, result);
+    } else if (a->kind == BLOCK_FULL || b->kind == BLOCK_FULL) {
+        result->kind = BLOCK_FULL;
+        result->card = length;
+    } else {
+        block_to_words(a, scratch, length);
+
+        if (b->kind == BLOCK_ARRAY) {
+            for (int i = 0; i < b->card; i++) {
+                int pos = b->positions[i];
+                scratch[pos / 64] |= (uint64_t)1 << (pos % 64);
+            }
+        } else {
+            for (int w = 0; w < BLOCK_WORDS; w++) {
+                scratch[w] |= b->words[w];
+            }
+        }
+
+        words_to_block(scratch, result, length);
+    }
+}
+
+/* inter_block
+ *    Purpose: Computes the bitwise and of two blocks into an empty block
+ * Parameters: pointers to the two input blocks and the empty result, the
+ *             block length, and a BLOCK_WORDS-long scratch array
+ *    Returns: void
+ *
+ *       Note: Two array blocks are intersected by merging, and an array
+ *             block is filtered against a dense one, so only dense-dense
+ *             pairs touch all 1024 words.
+ */
+static void inter_block(Block *a, Block *b, Block *result, int length,
+                                                       uint64_t *scratch)
+{
+    if (a->kind == BLOCK_EMPTY || b->kind == BLOCK_EMPTY) {
+        return;
+    } else if (a->kind == BLOCK_FULL) {
+        copy_block(b, result);
+        return;
+    } else if (b->kind == BLOCK_FULL) {
+        copy_block(a, result);
+        return;
+    }
+
+    if (a->kind == BLOCK_DENSE && b->kind == BLOCK_DENSE) {
+        for (int w = 0; w < BLOCK_WORDS; w++) {
+            scratch[w] = a->words[w] & b->words[w];
+        }
+        words_to_block(scratch, result, length);
+        return;
+    }
+
+    if (a->kind == BLOCK_DENSE) {
+        Block *temp = a;
+        a = b;
+        b = temp;
+    }
+
+    /* a is now an array block and the result fits in an array */
+    result->kind = BLOCK_ARRAY;
+    result->capacity = a->card;
+    result->positions = malloc(a->card * sizeof(uint16_t));
+    assert (result->positions != NULL);
+
+    int n = 0;
+    if (b->kind == BLOCK_DENSE) {
+        for (int i = 0; i < a->card; i++) {
+            int pos = a->positions[i];
+            if ((b->words[pos / 64] >> (pos % 64)) & 1) {
+                result->positions[n++] = pos;
+            }
+        }
+    } else {
+        int i = 0;
+        int j = 0;
+        while (i < a->card && j < b->card) {
+            if (a->positions[i] < b->positions[j]) {
+                i++;
+            } else if (a->positions[i] > b->positions[j]) {
+                j++;
+            } else {
+                result->positions[n++] = a->positions[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    result->card = n;
+    normalize_block(result, length);
+}
+
+/* put_in_bit2
+ *    Purpose: Sparse2_map_set apply function that sets the same bit in
+ *             the Bit2 held by a CopyData closure
+ * Parameters: the column and row of the set bit, the Sparse2, and a void
+ *             pointer to the CopyData
+ *    Returns: void
+ */
+static void put_in_bit2(int col, int row, T a, void *p1)
+{
+    (void)a;
+    Bit2_put(((CopyData *)p1)->bit2, col, row, 1);
+}
@@ -0,0 +1,188 @@
+/**************************************************************
+ *
+ *                     sparse2.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The Sparse2 interface is an abstraction that implements
+ *     compressed two-dimensional arrays of bits for images that
+ *     are mostly white. Pixels are numbered in row-major order
+ *     and grouped into blocks of 65536; each block is stored as
+ *     whichever is smallest of empty, full, a sorted array of
+ *     set positions, or a dense array of words, in the style of
+ *     Roaring bitmaps. Bulk operations skip empty blocks.
+ *
+ **************************************************************/
+
+#ifndef __SPARSE2__
+#define __SPARSE2__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <bit2.h>
+#define T Sparse2_T
+
+typedef struct T *T;
+
+/* Sparse2_new
+ * Purpose: Creates a new, all-zero Sparse2 of a given width and height
+ * Parameters: integers representing width and height of the Sparse2
+ * Returns: the new Sparse2
+ * Expected input: a width and height that are both greater than 0
+ * Success output: a new Sparse2 with no set bits is returned
+ * Failure output: if the width or height are invalid, a Hanson CRE
+ *                 is raised
+ */
+T Sparse2_new(int width, int height);
+
+/* Sparse2_from_bit2
+ * Purpose: Creates a Sparse2 holding the same bits as a Bit2
+ * Parameters: the Bit2
+ * Returns: the new Sparse2
+ * Expected input: a valid Bit2
+ * Success output: a Sparse2 with the Bit2's dimensions and bits
+ * Failure output: if the Bit2 is null, a Hanson CRE is raised
+ */
+T Sparse2_from_bit2(Bit2_T bit2);
+
+/* Sparse2_to_bit2
+ * Purpose: Creates a Bit2 holding the same bits as a Sparse2
+ * Parameters: the Sparse2
+ * Returns: the new Bit2
+ * Expected input: a valid Sparse2
+ * Success output: a Bit2 with the Sparse2's dimensions and bits
+ * Failure output: if the Sparse2 is null, a Hanson CRE is raised
+ */
+Bit2_T Sparse2_to_bit2(T sparse2);
+
+/* Sparse2_get
+ * Purpose: Get the value stored in target location
+ * Parameters: the Sparse2 and two ints for the column and row of the
+ *             target bit
+ * Returns: an int representing the target bit's stored value
+ * Expected input: a valid Sparse2 and a column and row that are both
+ *                 within the bounds of the Sparse2
+ * Success output: the value of the desired bit is returned
+ * Failure output: if the Sparse2 is null, or if the column and row are
+ *                 not within the bounds of the Sparse2, a Hanson CRE is
+ *                 raised
+ */
+int Sparse2_get(T sparse2, int col, int row);
+
+/* Sparse2_put
+ * Purpose: Store value in target location in a Sparse2
+ * Parameters: the Sparse2 and two ints for the column and row of where
+ *             new bit will be placed, as well as the new bit value
+ * Returns: the previous value stored in the target location
+ * Expected input: a valid Sparse2 and a column and row that are both
+ *                 within the bounds of the Sparse2, as well as a value
+ *                 of 0 or 1
+ * Success output: returns the previous value stored at the target location
+ * Failure output: if the Sparse2 is null, or if the column and row are
+ *                 not within the bounds of the Sparse2, or if the value
+ *                 is not a 0 or a 1, a Hanson CRE is raised
+ *           Note: The block holding the bit may change representation.
+ */
+int Sparse2_put(T sparse2, int col, int row, int value);
+
+/* Sparse2_width
+ * Purpose: Returns the width of a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the width of the Sparse2 as an integer
+ * Expected input: a valid Sparse2
+ * Success output: returns the width of the Sparse2
+ * Failure output: if the Sparse2 is null, a Hanson CRE is raised
+ */
+int Sparse2_width(T sparse2);
+
+/* Sparse2_height
+ * Purpose: Returns the height of a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the height of the Sparse2 as an integer
+ * Expected input: a valid Sparse2
+ * Success output: returns the height of the Sparse2
+ * Failure output: if the Sparse2 is null, a Hanson CRE is raised
+ */
+int Sparse2_height(T sparse2);
+
+/* Sparse2_count
+ * Purpose: Returns the number of set bits in a given Sparse2
+ * Parameters: the Sparse2
+ * Returns: the number of bits that are 1
+ * Expected input: a valid Sparse2
+ * Success output: returns the count, without visiting any bits
+ * Failure output: if the Sparse2 is null, a Hanson CRE is raised
+ */
+long Sparse2_count(T sparse2);
+
+/* Sparse2_memory
+ * Purpose: Returns the number of bytes of heap memory a Sparse2 uses
+ * Parameters: the Sparse2
+ * Returns: the size of the Sparse2's struct, block table and containers
+ * Expected input: a valid Sparse2
+ * Success output: returns the memory footprint in bytes
+ * Failure output: if the Sparse2 is null, a Hanson CRE is raised
+ */
+size_t Sparse2_memory(T sparse2);
+
+/* Sparse2_map_set
+ * Purpose: Visit every set bit of a given Sparse2 in row-major order,
+ *             calling the apply function on each and building up the
+ *             closure value across iterations
+ * Parameters: the Sparse2, function pointer to the function to apply to
+ *             each set bit, and void pointer to the closure value
+ * Returns: none
+ * Expected input: a valid Sparse2, a function pointer with matching
+ *                 apply function parameters, and either a closure
+ *                 pointer or a null closure parameter
+ * Success output: none
+ * Failure output: if either the Sparse2 or the apply function are null, a
+ *                 Hanson CRE is raised
+ *           Note: The apply function parameters are ints representing the
+ *                 column and row of the current set bit, the Sparse2, and
+ *                 the closure parameter as a void pointer. The apply
+ *                 function must not change the Sparse2.
+ */
+void Sparse2_map_set(T sparse2, void apply(int col, int row, T a,
+                                           void *p1), void *cl);
+
+/* Sparse2_union
+ * Purpose: Creates a Sparse2 that is the bitwise or of two others
+ * Parameters: the two Sparse2s
+ * Returns: the new Sparse2
+ * Expected input: two valid Sparse2s with the same width and height
+ * Success output: a new Sparse2 whose bits are 1 where either input is 1
+ * Failure output: if either Sparse2 is null or their dimensions differ,
+ *                 a Hanson CRE is raised
+ */
+T Sparse2_union(T s, T t);
+
+/* Sparse2_inter
+ * Purpose: Creates a Sparse2 that is the bitwise and of two others
+ * Parameters: the two Sparse2s
+ * Returns: the new Sparse2
+ * Expected input: two valid Sparse2s with the same width and height
+ * Success output: a new Sparse2 whose bits are 1 where both inputs are 1
+ * Failure output: if either Sparse2 is null or their dimensions differ,
+ *                 a Hanson CRE is raised
+ */
+T Sparse2_inter(T s, T t);
+
+/* Sparse2_free
+ * Purpose: Frees memory associated with a given Sparse2, including all
+ *          of its blocks.
+ * Parameters: a pointer to the Sparse2 to free
+ * Returns: void
+ * Expected input: non-null pointer to a valid Sparse2
+ * Success output: none
+ * Failure output: if either the Sparse2 pointer or the Sparse2 itself are
+ *                 null, a Hanson CRE is raised
+ */
+void Sparse2_free(T *sparse2);
+
+#undef T
+#endif /* __SPARSE2__ */
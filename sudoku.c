@@ -1,6 +1,6 @@
 /**************************************************************
  *
- *           sudoku – checks the valifity of a 
+ *           sudoku – checks the valifity of a
  *                    nine-by-nine sudoku solution
  *
  *     Assignment: iii
@@ -8,328 +8,241 @@
  *     Date:     Oct 4, 2021
  *
  *     Summary
- *     This program checks the validity of a nine-by-nine sudoku 
- *     solution
+ *     This program checks the validity of a nine-by-nine sudoku
+ *     solution, or of every solution in a stream of them. PGM input
+ *     may also be any N*N by N*N sudoku with N-by-N boxes (4 x 4,
+ *     16 x 16, 25 x 25, ...), with the size taken from its header.
+ *
+ *     Usage:
+ *       sudoku [pgmfile]
+ *       sudoku -batch [-compact [-threads N]] [file]
+ *       sudoku [-batch [-compact]] -solve [-unique] [file]
+ *
+ *       With -batch the input is a stream of puzzles: concatenated
+ *       PGMs, or with -compact 81 digits per puzzle (row by row, an
+ *       optional newline after each). One line is written per
+ *       puzzle, holding the exit code the puzzle would get on its
+ *       own. The same buffers are reused for every puzzle.
+ *       Compact batches are checked on N threads (default 1, 0 for one
+ *       per processor, and at most 32), still writing lines in input
+ *       order.
+ *
+ *       With -solve, 0 cells (or '.' in compact input) are blanks to
+ *       fill in, and each solved puzzle is written to standard output
+ *       in the format it was read in. Only nine-by-nine puzzles can
+ *       be solved. A puzzle with no solution is
+ *       written back as it was read. -unique also asks that each
+ *       puzzle have only one solution.
  *
  *     Input:
  *       A pgm file containing the sudoku solution
  *
  *     Success output:
- *       exit with code 0 if the solution is valid, and 1 if otherwise
+ *       exit with code 0 if the solution is valid, and 1 if otherwise;
+ *       in batch mode, exit with code 0 if every solution is valid;
+ *       with -solve, exit with code 0 if every puzzle was solved (and,
+ *       with -unique, had only one solution)
  *
  *     Failure output:
  *       A Hanson checked runtime exception is raised if
  *       there is a problem accessing or reading the input,
- *       if the input pgm is invalid, if the maximum pixel
- *       intensity is not nine, pixel has zero intensity.
+ *       if the input pgm is invalid, or if the width and height
+ *       are not N*N and the maximum pixel intensity N*N for some
+ *       N from 1 to 8.
  *
  *
  **************************************************************/
- 
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 
-#include <uarray2.h>
-#include <pnmrdr.h>
-
-FILE * OpenFile(int argc, char *argv[]);
+#include <sudokucheck.h>
 
-int read_data(UArray2_T uarray2, FILE *fp);
-int check_pixel_val(int pixel_val);
-
-void populate_uarray2(UArray2_T uarray2, int line_length, int *line_data,
-                                                            int line_num);
-void init_empty_uarray2(UArray2_T uarray2, int line_length);
-
-int check_numbers(UArray2_T uarray2);
-void calc_frequencies(int i, int j, UArray2_T a, void *p1, void *p2);
-int find_submap_index(int col, int row);
-
-typedef struct FrequencyData *FrequencyData;
-struct FrequencyData {
-    UArray2_T frequency_array;
-    int solved;
-};
+FILE *OpenFile(char *filename);
+int parse_threads(const char *arg);
+int check_batch(FILE *fp, Sudoku_format format);
+int solve_puzzles(FILE *fp, Sudoku_format format, int limit, int batch);
+void usage(void);
 
 int main(int argc, char *argv[])
 {
-    FILE *fp = OpenFile(argc, argv);
-    
-    UArray2_T uarray2;
-    uarray2 = UArray2_new(9, 9, sizeof(int));
+    int batch = 0;
+    Sudoku_format format = Sudoku_PGM;
+    char *filename = NULL;
+    int num_threads = -1;
+    int solve = 0;
+    int unique = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-batch") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "-compact") == 0) {
+            format = Sudoku_COMPACT;
+        } else if (strcmp(argv[i], "-solve") == 0) {
+            solve = 1;
+        } else if (strcmp(argv[i], "-unique") == 0) {
+            unique = 1;
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            num_threads = parse_threads(argv[++i]);
+        } else if (argv[i][0] == '-' || filename != NULL) {
+            usage();
+        } else {
+            filename = argv[i];
+        }
+    }
+    if ((format == Sudoku_COMPACT && !batch) || (unique && !solve)
+        || (num_threads >= 0 && (format != Sudoku_COMPACT || solve))) {
+        usage();
+    }
+
+    FILE *fp = OpenFile(filename);
+    int exit_code;
+
+    if (solve) {
+        /* looking for a second solution tells whether there is one */
+        exit_code = solve_puzzles(fp, format, unique ? 2 : 1, batch);
+    } else if (batch && format == Sudoku_COMPACT) {
+        int threads = num_threads < 0 ? 1 : num_threads;
+        exit_code = Sudoku_batch(fp, stdout, threads) > 0;
+    } else if (batch) {
+        exit_code = check_batch(fp, format);
+    } else {
+        Sudoku_T sudoku = Sudoku_new();
+        int read = Sudoku_read(sudoku, fp, Sudoku_PGM);
+        assert(read == 1);
 
-    /* if file represents a wrong sudoku solution */
-    if (read_data(uarray2, fp) == 1 || check_numbers(uarray2) == 1) {
-        UArray2_free(&uarray2);
-        fclose(fp);
-        return 1;
+        /* 0 if file represents a solved sudoku puzzle */
+        exit_code = !Sudoku_check(sudoku);
+        Sudoku_free(&sudoku);
     }
 
-    /* if file represents a solved sudoku puzzle */
-    UArray2_free(&uarray2);
     fclose(fp);
 
-    return 0;
+    return exit_code;
 }
 
-/* OpenFile
- *    Purpose: Attempts to open a file from the command line, throwing errors
- *             in the three cases described below.
- * Parameters: number of command line arguments as an int and the
- *             characters of each argument as a char array
- *    Returns: A file pointer for input stream
- * Expected input: number of command line arguments, and characters of each 
- *                 argument
- * Success output: a file pointer for a file or standard input
- * Failure output: if an argument is supplied and fails to open, a Hanson CRE
- *                 is raised
+/* check_batch
+ *    Purpose: Checks every puzzle in a stream one at a time, writing one
+ *             line per puzzle
+ * Parameters: a file pointer for the input stream and the format of
+ *             its puzzles
+ *    Returns: 0 if every puzzle is solved, and 1 otherwise
  *
- *       Note: Throws a checked runtime error if
- *             1. More than one argument is supplied
- *             2. The named input file cannot be opened
- *             3. An error is encountered reading from an input file
+ *       Note: Each line is 0 for a solved puzzle and 1 otherwise, the
+ *             exit code the puzzle would get on its own.
  */
-FILE *OpenFile(int argc, char *argv[])
+int check_batch(FILE *fp, Sudoku_format format)
 {
-    assert(argc <= 2);
+    Sudoku_T sudoku = Sudoku_new();
+    int exit_code = 0;
 
-    /*
-     * set file pointer to stdin to handle command line input in the case
-     * that no file is supplied
-    */
-    FILE *fp;
-    fp = stdin;
+    while (Sudoku_read(sudoku, fp, format)) {
+        int solved = Sudoku_check(sudoku);
 
-    /*
-     * if a file is supplied as an argument, open the file and make fp 
-     * point to the opened filestream
-    */
-    if (argc == 2) {
-        fp = fopen(argv[1], "r");
+        fputs(solved ? "0\n" : "1\n", stdout);
+        exit_code |= !solved;
     }
-    
-    assert(fp != NULL);
-    
-    return fp;
+
+    Sudoku_free(&sudoku);
+
+    return exit_code;
 }
 
-/* read_data
- *    Purpose: Read in the data with pnm reader to populate a uarray2.
- * Parameters: The uarray2 to store information in, and a file pointer for
- *             input stream.
- *    Returns: None
- * Expected input: a valid uarray2
- * Success output: an exit code for whether or not the sukudo is valid
- * Failure output: if width, height, or mavel isn't 9, less than 81 pixels
- *                 are stored in the pbm, and the filestream is not a valid 
- *                 pgm (P2 or P5), a Hanson CRE is raised
+/* solve_puzzles
+ *    Purpose: Solves one puzzle, or every puzzle in a stream, writing
+ *             each result to standard output
+ * Parameters: a file pointer for the input stream, the format of its
+ *             puzzles, the most solutions to look for, and whether to
+ *             read a whole stream
+ *    Returns: 0 if every puzzle has exactly one solution among those
+ *             looked for, and 1 otherwise
  */
-int read_data(UArray2_T uarray2, FILE *fp){
-    Pnmrdr_T rdr = Pnmrdr_new(fp);
-    Pnmrdr_mapdata data = Pnmrdr_data(rdr);
-    assert(data.type == 2);
+int solve_puzzles(FILE *fp, Sudoku_format format, int limit, int batch)
+{
+    Sudoku_T sudoku = Sudoku_new();
+    int exit_code = 0;
 
-    unsigned width = data.width;
-    unsigned height = data.height;
-    assert(width == 9 && height == 9 && data.denominator == 9);
-    
-    int invalid_digit = 0;
+    while (Sudoku_read(sudoku, fp, format)) {
+        exit_code |= Sudoku_solve(sudoku, limit) != 1;
+        Sudoku_write(sudoku, stdout, format);
 
-    for (int i = 0; i < 9; i++) {
-        int *line_data;
-        
-        line_data = malloc(9 * sizeof(int));
-        assert(line_data != NULL);
-        
-        unsigned digit;
-        
-        for (int j = 0; j < 9; j++){
-            digit = Pnmrdr_get(rdr);
-            line_data[j] = digit;
-            if (check_pixel_val(digit) == 1) {
-                invalid_digit = 1;
-            }
+        if (!batch) {
+            break;
         }
-        
-        populate_uarray2(uarray2, 9, line_data, i);
-        free(line_data);
-    }
-    
-    Pnmrdr_free(&rdr);
-
-    if (invalid_digit) {
-        return 1;
-    } else {
-        return 0;
     }
-}
 
-/* check_pixel_val
- *    Purpose: Check if the pixel value is in scope
- * Parameters: an int for the pixel value
- *    Returns: an int for whether or not the current pixel value is in sope
- * Expected input: a pixel's intensity
- * Success output: an exit code for whether or not it is a valid sudoku
- * Failure output: none
- *
- *       Note: In scope means its value is 0 to 9, inclusive
- */
-int check_pixel_val(int pixel_val)
-{
-    if (pixel_val < 1 || pixel_val > 9) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
+    Sudoku_free(&sudoku);
 
-/* populate_uarray2
- *    Purpose: Populate a line in the uarray2
- * Parameters: the uarray2, the length of line, an int pointer for a buffer
- *             that stores the information, and a int for the taget line
- *             number in the uarray2
- *    Returns: void
- * Expected input: a valid uarray2 , the length of a line, all the stored 
- *                 informaton, and the number of elments in a line
- * Success output: none
- * Failure output: none
- *
- */
- void populate_uarray2(UArray2_T uarray2, int line_length, int *line_data,
-                                                            int line_num)
-{
-    for (int i = 0; i < line_length; i++) {
-        int curr_num = line_data[i];
-        *((int *)UArray2_at(uarray2, i, line_num)) = curr_num;
-    }
+    return exit_code;
 }
 
-/* init_empty_uarray2
- *    Purpose: Populate an empty uarray2
- * Parameters: an uarray2, an int for the line length
- *    Returns: void
- * Expected input: a valid uarray2 and the length of a line
- * Success output: none
- * Failure output: if memory allocation failed, a Hanson CRE is raised
+/* parse_threads
+ *    Purpose: Reads the thread count given with -threads
+ * Parameters: the argument after -threads
+ *    Returns: the thread count; exits through usage if the argument is
+ *             not a whole number from 0 to SUDOKU_MAX_THREADS
  */
-void init_empty_uarray2(UArray2_T uarray2, int line_length)
+int parse_threads(const char *arg)
 {
-    // initialize everything in frequency_array to zero
-    int *line_data = malloc(27 * sizeof(int));
-    assert(line_data != NULL);
-        
-    for (int j = 0; j < line_length; j++){
-        line_data[j] = 0;
-    }
+    char *end;
+    long threads = strtol(arg, &end, 10);
 
-    for (int i = 0; i < UArray2_height(uarray2); i++) {
-        populate_uarray2(uarray2, line_length, line_data, i);
+    if (!isdigit((unsigned char)arg[0]) || *end != '\0'
+        || threads > SUDOKU_MAX_THREADS) {
+        usage();
     }
 
-    free(line_data);
+    return (int)threads;
 }
 
-/* check_numbers
- *    Purpose: Check if the nine-by-nine submaps  sudoku is valid
- * Parameters: an uarray2 that stores the information
- *    Returns: an int for whether or not the sudoky is valid
- * Expected input: a valid uarray2 storing the information
- * Success output: an exit code for whether or not it is a valid sudoku
- * Failure output: none
- *
- *       Note: A sudoku is valid when
- *             1. No pixels have the same number in each row.
- *             2. No pixels have the same number in each column.
- *             3. In each of three-by-three submaps, no two pixels have 
- *                the same number.
+/* usage
+ *    Purpose: Prints the usage message and exits with code 1
+ * Parameters: none
+ *    Returns: does not return
  */
-int check_numbers(UArray2_T uarray2){
-    FrequencyData freq_data = malloc(sizeof(struct FrequencyData));
-
-    /* Assume sudoku is solved until proven wrong */
-    freq_data->solved = 1;
-    freq_data->frequency_array = UArray2_new(9, 27, sizeof(int));
-
-    init_empty_uarray2(freq_data->frequency_array, 9);
-
-    UArray2_map_col_major(uarray2, calc_frequencies, freq_data);
-
-    printf("SOLVED IS %d\n", freq_data->solved);
-    int solved = freq_data->solved;
-
-    /* Free frequency data on the heap */
-    UArray2_free(&freq_data->frequency_array);
-    free(freq_data);
-
-    return solved;
+void usage(void)
+{
+    fprintf(stderr, "Usage: sudoku [pgmfile]\n"
+                    "       sudoku -batch [-compact [-threads N]] [file]\n"
+                    "       sudoku [-batch [-compact]] -solve [-unique] "
+                    "[file]\n");
+    exit(1);
 }
 
-/* calc_frequencies
- *    Purpose: Calculate the frequency of a number's apperance in 
- *             column, row, and submap using folding
- * Parameters: an int for the column number, and int for the row number,
- *             an urray2, a void pointer for the current element that
- *             needs to be checked, and a void pointer for the closure
- *             (which will store a FrequencyTable)
- *    Returns: void
- * Expected input: column number, row number, a valid array, the current
- *                 element, and FrequencyData containing the freq_uarray
- * Success output: an exit code for whether or not it is a valid sudoku
- * Failure output: none
+/* OpenFile
+ *    Purpose: Attempts to open the file named on the command line,
+ *             throwing errors in the two cases described below.
+ * Parameters: the file name, or NULL to read standard input
+ *    Returns: A file pointer for input stream
+ * Expected input: a file name or NULL
+ * Success output: a file pointer for a file or standard input
+ * Failure output: if a file is named and fails to open, a Hanson CRE
+ *                 is raised
  *
+ *       Note: Throws a checked runtime error if
+ *             1. The named input file cannot be opened
+ *             2. An error is encountered reading from an input file
  */
-void calc_frequencies(int i, int j, UArray2_T a, void *p1, void *p2)
+FILE *OpenFile(char *filename)
 {
-    assert(p1 == UArray2_at(a, i, j));
-    int *curr_num = p1;
-    
-    UArray2_T freq_uarray = ((FrequencyData)p2)->frequency_array;
-
-    int *num_col_freq = (int *)UArray2_at(freq_uarray, *curr_num - 1, i);
-    *num_col_freq += 1;
-
-    int *num_row_freq = (int *)UArray2_at(freq_uarray, *curr_num - 1, j + 9);
-    *num_row_freq += 1;
-
-    int submap = find_submap_index(i, j);
-    int *num_submap_freq = (int *)UArray2_at(freq_uarray, *curr_num - 1, 
-                                                            submap + 18);
-    *num_submap_freq += 1;
+    /*
+     * set file pointer to stdin to handle command line input in the case
+     * that no file is supplied
+    */
+    FILE *fp;
+    fp = stdin;
 
-    if (*num_submap_freq == 2 || *num_col_freq == 2 || *num_row_freq == 2) {
-        ((FrequencyData)p2)->solved = 0;
-        printf("map_solved is %d\n", ((FrequencyData)p2)->solved);
+    /*
+     * if a file is supplied as an argument, open the file and make fp
+     * point to the opened filestream
+    */
+    if (filename != NULL) {
+        fp = fopen(filename, "r");
     }
-}
 
-/* find_submap_index
- *    Purpose: Calculate the element's submap index for frequency_array
- * Parameters: an int for the column number and an int for the row column
- *    Returns: an int for the index
- * Expected input: column number and row number
- * Success output: the submap index
- * Failure output: none
- */
-int find_submap_index(int col, int row)
-{
-    if (col <= 2 && row <= 2) {
-        return 0;
-    } else if (col <= 5 && row <= 2) {
-        return 1;
-    } else if (col <= 8 && row <= 2) {
-        return 2;
-    } else if (col <= 2 && row <= 5) {
-        return 3;
-    } else if (col <= 5 && row <= 5) {
-        return 4;
-    } else if (col <= 8 && row <= 5) {
-        return 5;
-    } else if (col <= 2 && row <= 8) {
-        return 6;
-    } else if (col <= 5 && row <= 8) {
-        return 7;
-    } else {
-        return 8;
-    }
+    assert(fp != NULL);
+
+    return fp;
 }
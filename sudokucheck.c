@@ -0,0 +1,1369 @@
+/**************************************************************
+ *
+ *                     sudokucheck.c
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *       Implementation of the Sudoku interface. The puzzle is kept
+ *       as one byte per cell, row by row, and checked with a mask
+ *       per row, column and box recording which digits the unit
+ *       already holds; the first digit whose bit is already set, or
+ *       that is out of range, settles the verdict. Compact puzzles
+ *       are checked as they are read. PGM puzzles are checked by a
+ *       kernel for their box size: CHECK_KERNEL builds unrolled ones
+ *       for the common sizes, and check_general covers the rest.
+ *       The masks live on the stack, so checking allocates nothing.
+ *
+ **************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <string.h>
+#include <limits.h>
+#include <parallel.h>
+#include <sudokucheck.h>
+
+/* SSE2 is part of every x86-64; AVX2 is compiled per function and used
+ * only when the CPU reports it */
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SUDOKU_SIMD 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SUDOKU_SIMD 0
+#endif
+
+#define T Sudoku_T
+
+/* Compact puzzles, the vector kernels and the solver are nine by nine,
+ * with one byte per cell */
+#define SIDE 9
+#define CELLS (SIDE * SIDE)
+
+/* PGM puzzles have boxes of up to MAX_BOX by MAX_BOX cells, so that a
+ * unit's digits fit the bits of a uint64_t */
+#define MAX_BOX 8
+#define MAX_SIDE (MAX_BOX * MAX_BOX)
+#define MAX_CELLS (MAX_SIDE * MAX_SIDE)
+
+struct T {
+    uint8_t grid[MAX_CELLS];    /* the digits, row by row */
+    int box;                    /* the side of a box, N */
+    int side;                   /* the side of the grid, N * N */
+    int solved;                 /* the verdict on the puzzle last read */
+    int loaded;                 /* a puzzle has been read */
+};
+
+/* Asks GCC to unroll a loop with a constant trip count completely */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+#define UNROLL _Pragma("GCC unroll 25")
+#else
+#define UNROLL
+#endif
+
+/* CHECK_KERNEL(N, MASK) defines check_boxN, which checks an N*N by N*N
+ * grid with N known at compile time, so the divisions become multiplies
+ * and the loop over a row is unrolled. Bit d - 1 of a MASK is set once
+ * digit d has been seen in that unit, so MASK needs N * N bits. Rows
+ * are stride bytes apart, and the result is the row-major index of the
+ * first bad cell, or -1 if the grid is solved. */
+#define CHECK_KERNEL(N, MASK)                                             \
+static int check_box##N(const uint8_t *grid, size_t stride)               \
+{                                                                         \
+    MASK rows[N * N] = { 0 };                                             \
+    MASK cols[N * N] = { 0 };                                             \
+    MASK boxes[N * N] = { 0 };                                            \
+                                                                          \
+    for (int row = 0; row < N * N; row++, grid += stride) {               \
+        UNROLL                                                            \
+        for (int col = 0; col < N * N; col++) {                           \
+            unsigned digit = grid[col] - 1u;                              \
+            int box = row / N * N + col / N;                              \
+            if (digit >= N * N) {                                         \
+                return row * N * N + col;                                 \
+            }                                                             \
+                                                                          \
+            MASK bit = (MASK)1 << digit;                                  \
+            if ((rows[row] | cols[col] | boxes[box]) & bit) {             \
+                return row * N * N + col;                                 \
+            }                                                             \
+            rows[row] |= bit;                                             \
+            cols[col] |= bit;                                             \
+            boxes[box] |= bit;                                            \
+        }                                                                 \
+    }                                                                     \
+                                                                          \
+    return -1;                                                            \
+}
+
+/* Puzzles per chunk of a batch, and chunks per window; a window is
+ * the same size for any thread count, with at least 4 chunks for each
+ * of SUDOKU_MAX_THREADS workers */
+#define BATCH_CHUNK 1024
+#define WINDOW_CHUNKS 128
+#define WINDOW_PUZZLES ((size_t)WINDOW_CHUNKS * BATCH_CHUNK)
+
+/* One window of a batch: the raw bytes read for it, where each of its
+ * puzzles starts in them, and a verdict slot per puzzle that the
+ * workers fill in whatever order they finish */
+typedef struct Window {
+    char *raw;
+    size_t raw_len;
+    size_t leftover;        /* bytes at the end that start the next one */
+    size_t *starts;
+    int num_puzzles;
+    uint8_t *verdicts;
+} Window;
+
+/* A batch in flight. Two windows take turns: while the workers check
+ * one, the first job of the round writes the lines of the other and
+ * then reads the next window into it. Errors in that job are only
+ * recorded, and raised on the calling thread. */
+typedef struct Batch {
+    FILE *in;
+    FILE *out;
+    size_t raw_cap;
+    int at_eof;
+    int truncated;          /* the stream ended inside a puzzle */
+    int write_failed;
+    Window windows[2];
+    Window *checking;       /* checked this round */
+    Window *other;          /* written, then read, this round */
+    int other_checked;      /* other holds verdicts not yet written */
+    char *lines;
+    int unsolved;
+    uint8_t *scratch;       /* BATCH_CHUNK grids for each worker */
+} Batch;
+
+/* Bit d of a mask is set once digit d has been seen in that unit */
+typedef struct Masks {
+    uint16_t rows[SIDE];
+    uint16_t cols[SIDE];
+    uint16_t boxes[SIDE];
+} Masks;
+
+/* A puzzle being solved: its cells, 0 for a blank, the digits used in
+ * each row, column and box, and how many cells are still blank */
+typedef struct Board {
+    uint8_t cells[CELLS];
+    uint16_t rows[SIDE];
+    uint16_t cols[SIDE];
+    uint16_t boxes[SIDE];
+    int blanks;
+} Board;
+
+/* The search: stop after limit solutions, keeping the first one */
+typedef struct Search {
+    int limit;
+    int found;
+    uint8_t solution[CELLS];
+} Search;
+
+/* The nine digit bits of a mask */
+#define ALL_DIGITS 0x3fe
+
+/* The cells of each unit: rows 0-8, columns 9-17 and boxes 18-26 */
+static const uint8_t unit_cells[3 * SIDE][SIDE] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8 },
+    {  9, 10, 11, 12, 13, 14, 15, 16, 17 },
+    { 18, 19, 20, 21, 22, 23, 24, 25, 26 },
+    { 27, 28, 29, 30, 31, 32, 33, 34, 35 },
+    { 36, 37, 38, 39, 40, 41, 42, 43, 44 },
+    { 45, 46, 47, 48, 49, 50, 51, 52, 53 },
+    { 54, 55, 56, 57, 58, 59, 60, 61, 62 },
+    { 63, 64, 65, 66, 67, 68, 69, 70, 71 },
+    { 72, 73, 74, 75, 76, 77, 78, 79, 80 },
+    {  0,  9, 18, 27, 36, 45, 54, 63, 72 },
+    {  1, 10, 19, 28, 37, 46, 55, 64, 73 },
+    {  2, 11, 20, 29, 38, 47, 56, 65, 74 },
+    {  3, 12, 21, 30, 39, 48, 57, 66, 75 },
+    {  4, 13, 22, 31, 40, 49, 58, 67, 76 },
+    {  5, 14, 23, 32, 41, 50, 59, 68, 77 },
+    {  6, 15, 24, 33, 42, 51, 60, 69, 78 },
+    {  7, 16, 25, 34, 43, 52, 61, 70, 79 },
+    {  8, 17, 26, 35, 44, 53, 62, 71, 80 },
+    {  0,  1,  2,  9, 10, 11, 18, 19, 20 },
+    {  3,  4,  5, 12, 13, 14, 21, 22, 23 },
+    {  6,  7,  8, 15, 16, 17, 24, 25, 26 },
+    { 27, 28, 29, 36, 37, 38, 45, 46, 47 },
+    { 30, 31, 32, 39, 40, 41, 48, 49, 50 },
+    { 33, 34, 35, 42, 43, 44, 51, 52, 53 },
+    { 54, 55, 56, 63, 64, 65, 72, 73, 74 },
+    { 57, 58, 59, 66, 67, 68, 75, 76, 77 },
+    { 60, 61, 62, 69, 70, 71, 78, 79, 80 },
+};
+
+/* The row, column and box of each cell */
+static const uint8_t cell_units[CELLS][3] = {
+    { 0, 0, 0 }, { 0, 1, 0 }, { 0, 2, 0 }, { 0, 3, 1 }, { 0, 4, 1 },
+    { 0, 5, 1 }, { 0, 6, 2 }, { 0, 7, 2 }, { 0, 8, 2 },
+    { 1, 0, 0 }, { 1, 1, 0 }, { 1, 2, 0 }, { 1, 3, 1 }, { 1, 4, 1 },
+    { 1, 5, 1 }, { 1, 6, 2 }, { 1, 7, 2 }, { 1, 8, 2 },
+    { 2, 0, 0 }, { 2, 1, 0 }, { 2, 2, 0 }, { 2, 3, 1 }, { 2, 4, 1 },
+    { 2, 5, 1 }, { 2, 6, 2 }, { 2, 7, 2 }, { 2, 8, 2 },
+    { 3, 0, 3 }, { 3, 1, 3 }, { 3, 2, 3 }, { 3, 3, 4 }, { 3, 4, 4 },
+    { 3, 5, 4 }, { 3, 6, 5 }, { 3, 7, 5 }, { 3, 8, 5 },
+    { 4, 0, 3 }, { 4, 1, 3 }, { 4, 2, 3 }, { 4, 3, 4 }, { 4, 4, 4 },
+    { 4, 5, 4 }, { 4, 6, 5 }, { 4, 7, 5 }, { 4, 8, 5 },
+    { 5, 0, 3 }, { 5, 1, 3 }, { 5, 2, 3 }, { 5, 3, 4 }, { 5, 4, 4 },
+    { 5, 5, 4 }, { 5, 6, 5 }, { 5, 7, 5 }, { 5, 8, 5 },
+    { 6, 0, 6 }, { 6, 1, 6 }, { 6, 2, 6 }, { 6, 3, 7 }, { 6, 4, 7 },
+    { 6, 5, 7 }, { 6, 6, 8 }, { 6, 7, 8 }, { 6, 8, 8 },
+    { 7, 0, 6 }, { 7, 1, 6 }, { 7, 2, 6 }, { 7, 3, 7 }, { 7, 4, 7 },
+    { 7, 5, 7 }, { 7, 6, 8 }, { 7, 7, 8 }, { 7, 8, 8 },
+    { 8, 0, 6 }, { 8, 1, 6 }, { 8, 2, 6 }, { 8, 3, 7 }, { 8, 4, 7 },
+    { 8, 5, 7 }, { 8, 6, 8 }, { 8, 7, 8 }, { 8, 8, 8 },
+};
+
+static int skip_space(FILE *fp);
+static int read_pgm(T sudoku, FILE *fp);
+static unsigned read_header_number(FILE *fp);
+static void read_plain_cells(FILE *fp, uint8_t *grid, int cells);
+static int read_compact(T sudoku, FILE *fp);
+static inline int mark_digit(Masks *masks, int row, int col, int box,
+                             unsigned digit);
+static int check_box2(const uint8_t *grid, size_t stride);
+static int check_box3(const uint8_t *grid, size_t stride);
+static int check_box4(const uint8_t *grid, size_t stride);
+static int check_box5(const uint8_t *grid, size_t stride);
+static int check_general(const uint8_t *grid, int box, size_t stride);
+static int check_any(const uint8_t *grid, int box, size_t stride);
+static Sudoku_unit find_conflict(const uint8_t *grid, int box,
+                                 size_t stride, int row, int col);
+static void blank_dots(uint8_t *grid, int cell);
+static int load_board(Board *board, const uint8_t *grid);
+static inline uint16_t candidates(const Board *board, int cell);
+static inline void place(Board *board, int cell, uint16_t bit);
+static int propagate(Board *board);
+static int search(Search *state, Board *board);
+static void fill_window(Batch *batch, Window *window, const Window *prev);
+static void write_window(Batch *batch, const Window *window);
+static void run_stage(int worker, int job, void *cl);
+static void check_chunk(Batch *batch, int worker, int chunk);
+#if SUDOKU_SIMD
+static void load_block_sse2(const uint8_t *grids, __m128i cells[CELLS]);
+static unsigned check_block_sse2(const uint8_t *grids);
+AVX2_TARGET static unsigned check_block_avx2(const uint8_t *grids);
+#endif
+
+/* Sudoku_new
+ * Purpose: Creates the grid for checking puzzles
+ * Parameters: none
+ * Returns: the new Sudoku_T
+ */
+T Sudoku_new(void)
+{
+    T sudoku = malloc(sizeof(struct T));
+    assert (sudoku != NULL);
+
+    sudoku->solved = 0;
+    sudoku->loaded = 0;
+
+    return sudoku;
+}
+
+/* Sudoku_read
+ * Purpose: Reads and checks the next puzzle of a stream
+ * Parameters: the Sudoku_T, the input stream, and its format
+ * Returns: 1 if a puzzle was read, or 0 at the end of the stream
+ */
+int Sudoku_read(T sudoku, FILE *fp, Sudoku_format format)
+{
+    assert (sudoku != NULL && fp != NULL);
+    assert (format == Sudoku_PGM || format == Sudoku_COMPACT);
+
+    int c = skip_space(fp);
+    if (c == EOF) {
+        return 0;
+    }
+    ungetc(c, fp);
+
+    if (format == Sudoku_PGM) {
+        sudoku->solved = read_pgm(sudoku, fp);
+    } else {
+        sudoku->solved = read_compact(sudoku, fp);
+    }
+    sudoku->loaded = 1;
+
+    return 1;
+}
+
+/* Sudoku_check
+ * Purpose: Reports whether the puzzle last read is a solved sudoku
+ * Parameters: the Sudoku_T
+ * Returns: 1 if the puzzle is solved, and 0 otherwise
+ */
+int Sudoku_check(T sudoku)
+{
+    assert (sudoku != NULL && sudoku->loaded);
+
+    return sudoku->solved;
+}
+
+/* Sudoku_validate
+ * Purpose: Checks an in-memory grid and says where it first goes wrong
+ * Parameters: the grid, the side of its boxes, and the distance between
+ *             its rows in bytes
+ * Returns: a Sudoku_result
+ */
+Sudoku_result Sudoku_validate(const uint8_t *grid, int box, size_t stride)
+{
+    assert (grid != NULL && box >= 1 && box <= MAX_BOX);
+    assert (stride >= (size_t)(box * box));
+
+    Sudoku_result result = { 1, Sudoku_NONE, -1, -1, -1 };
+    int side = box * box;
+    int cell = check_any(grid, box, stride);
+
+    if (cell >= 0) {
+        result.valid = 0;
+        result.row = cell / side;
+        result.col = cell % side;
+        result.unit = find_conflict(grid, box, stride, result.row,
+                                    result.col);
+        result.index = result.unit == Sudoku_ROW ? result.row
+                     : result.unit == Sudoku_COL ? result.col
+                     : result.unit == Sudoku_BOX
+                       ? result.row / box * box + result.col / box
+                     : cell;
+    }
+
+    return result;
+}
+
+/* Sudoku_has_kernel
+ * Purpose: Reports whether a Sudoku_kernel can run on this machine
+ * Parameters: the Sudoku_kernel
+ * Returns: 1 if it can, and 0 otherwise
+ */
+int Sudoku_has_kernel(Sudoku_kernel kernel)
+{
+    switch (kernel) {
+    case Sudoku_BEST:
+    case Sudoku_SCALAR:
+        return 1;
+#if SUDOKU_SIMD
+    case Sudoku_SSE2:
+        return 1;
+    case Sudoku_AVX2:
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    default:
+        return 0;
+    }
+}
+
+/* Sudoku_check_grids
+ * Purpose: Checks many in-memory grids, a block of them at a time
+ * Parameters: the grids, 81 digits each, the number of grids, an array
+ *             for one verdict per grid, and the Sudoku_kernel to use
+ * Returns: the number of solved grids
+ */
+int Sudoku_check_grids(const uint8_t *grids, int count, uint8_t *solved,
+                       Sudoku_kernel kernel)
+{
+    assert (grids != NULL && solved != NULL && count >= 0);
+    assert (Sudoku_has_kernel(kernel));
+
+    if (kernel == Sudoku_BEST) {
+        kernel = Sudoku_has_kernel(Sudoku_AVX2) ? Sudoku_AVX2
+               : Sudoku_has_kernel(Sudoku_SSE2) ? Sudoku_SSE2
+               : Sudoku_SCALAR;
+    }
+
+    int i = 0;
+#if SUDOKU_SIMD
+    /* each lane of a block is one grid, and bit k of the mask holds the
+     * verdict on grid k */
+    int lanes = kernel == Sudoku_AVX2 ? 32 : 16;
+    for (; kernel != Sudoku_SCALAR && i + lanes <= count; i += lanes) {
+        const uint8_t *block = grids + (size_t)i * CELLS;
+        unsigned mask = kernel == Sudoku_AVX2 ? check_block_avx2(block)
+                                              : check_block_sse2(block);
+
+        for (int k = 0; k < lanes; k++) {
+            solved[i + k] = (mask >> k) & 1;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        solved[i] = check_box3(grids + (size_t)i * CELLS, SIDE) < 0;
+    }
+
+    int total = 0;
+    for (i = 0; i < count; i++) {
+        total += solved[i];
+    }
+
+    return total;
+}
+
+/* Sudoku_batch
+ * Purpose: Checks a compact stream on several threads, writing one line
+ *          per puzzle in input order
+ * Parameters: the input and output streams and the number of threads
+ * Returns: the number of puzzles that are not solved
+ */
+int Sudoku_batch(FILE *in, FILE *out, int num_threads)
+{
+    assert (in != NULL && out != NULL && num_threads >= 0);
+
+    if (num_threads == 0) {
+        num_threads = Parallel_default_threads();
+    }
+    if (num_threads > SUDOKU_MAX_THREADS) {
+        num_threads = SUDOKU_MAX_THREADS;
+    }
+
+    Batch batch;
+    batch.in = in;
+    batch.out = out;
+    batch.raw_cap = WINDOW_PUZZLES * (CELLS + 1) + CELLS;
+    batch.at_eof = 0;
+    batch.truncated = 0;
+    batch.write_failed = 0;
+    batch.unsolved = 0;
+    batch.lines = malloc(2 * WINDOW_PUZZLES);
+    batch.scratch = malloc((size_t)num_threads * BATCH_CHUNK * CELLS);
+    assert (batch.lines != NULL && batch.scratch != NULL);
+
+    for (int w = 0; w < 2; w++) {
+        Window *window = &batch.windows[w];
+        window->raw = malloc(batch.raw_cap);
+        window->starts = malloc(WINDOW_PUZZLES * sizeof(size_t));
+        window->verdicts = malloc(WINDOW_PUZZLES);
+        assert (window->raw != NULL && window->starts != NULL
+                && window->verdicts != NULL);
+    }
+
+    /* only the first window is read with every worker idle */
+    fill_window(&batch, &batch.windows[0], NULL);
+    batch.checking = &batch.windows[0];
+    batch.other = &batch.windows[1];
+    batch.other_checked = 0;
+
+    /* a window without puzzles is the last only at the end of input */
+    while (batch.checking->num_puzzles > 0 || !batch.at_eof) {
+        int num_chunks = (batch.checking->num_puzzles + BATCH_CHUNK - 1)
+                         / BATCH_CHUNK;
+
+        /* job 0 is the I/O, so it is claimed first */
+        Parallel_chunks(num_threads, num_chunks + 1, run_stage, &batch);
+
+        Window *checked = batch.checking;
+        batch.checking = batch.other;
+        batch.other = checked;
+        batch.other_checked = 1;
+    }
+    if (batch.other_checked) {
+        write_window(&batch, batch.other);
+    }
+    assert (!batch.truncated && !batch.write_failed);
+
+    for (int w = 0; w < 2; w++) {
+        free(batch.windows[w].raw);
+        free(batch.windows[w].starts);
+        free(batch.windows[w].verdicts);
+    }
+    free(batch.lines);
+    free(batch.scratch);
+
+    return batch.unsolved;
+}
+
+/* Sudoku_solve
+ * Purpose: Fills in the blanks of the puzzle last read
+ * Parameters: the Sudoku_T and the most solutions to look for
+ * Returns: the number of solutions found, at most limit
+ */
+int Sudoku_solve(T sudoku, int limit)
+{
+    assert (sudoku != NULL && sudoku->loaded && limit >= 1);
+    assert (sudoku->side == SIDE);
+
+    Board board;
+    if (!load_board(&board, sudoku->grid)) {
+        return 0;
+    }
+
+    Search state;
+    state.limit = limit;
+    state.found = 0;
+    search(&state, &board);
+
+    if (state.found > 0) {
+        memcpy(sudoku->grid, state.solution, CELLS);
+        sudoku->solved = 1;
+    }
+
+    return state.found;
+}
+
+/* Sudoku_write
+ * Purpose: Writes the grid of a Sudoku_T to a stream
+ * Parameters: the Sudoku_T, the output stream, and the format to use
+ * Returns: none
+ */
+void Sudoku_write(T sudoku, FILE *fp, Sudoku_format format)
+{
+    assert (sudoku != NULL && sudoku->loaded && fp != NULL);
+    assert (format == Sudoku_PGM || format == Sudoku_COMPACT);
+    assert (format == Sudoku_PGM || sudoku->side == SIDE);
+
+    int side = sudoku->side;
+    if (format == Sudoku_PGM) {
+        fprintf(fp, "P2\n%d %d\n%d\n", side, side, side);
+    }
+
+    /* cells that were not digits are written as blanks */
+    for (int cell = 0; cell < side * side; cell++) {
+        int digit = sudoku->grid[cell] <= side ? sudoku->grid[cell] : 0;
+
+        if (format == Sudoku_COMPACT) {
+            putc('0' + digit, fp);
+        } else {
+            fprintf(fp, "%d%c", digit, cell % side == side - 1 ? '\n' : ' ');
+        }
+    }
+    if (format == Sudoku_COMPACT) {
+        putc('\n', fp);
+    }
+
+    assert (!ferror(fp));
+}
+
+/* Sudoku_free
+ * Purpose: Frees a Sudoku_T
+ * Parameters: a pointer to the Sudoku_T
+ * Returns: none
+ */
+void Sudoku_free(T *sudoku)
+{
+    assert (sudoku != NULL && *sudoku != NULL);
+
+    free(*sudoku);
+    *sudoku = NULL;
+}
+
+/* skip_space
+ *    Purpose: Skips whitespace in a stream
+ * Parameters: the input stream
+ *    Returns: the first character that is not whitespace, or EOF
+ */
+static int skip_space(FILE *fp)
+{
+    int c = getc(fp);
+    while (c != EOF && isspace(c)) {
+        c = getc(fp);
+    }
+
+    return c;
+}
+
+/* read_pgm
+ *    Purpose: Reads and checks one N*N by N*N plain (P2) or raw (P5) PGM
+ * Parameters: the Sudoku_T and the input stream
+ *    Returns: 1 if the puzzle is solved, and 0 otherwise
+ *
+ *       Note: The cells go straight into the grid: a raw raster with a
+ *             single fread, a plain one through read_plain_cells. The
+ *             whole grid is read, so the stream ends up at the next
+ *             puzzle and a puzzle with blanks can still be solved; the
+ *             check then stops at the first bad cell.
+ */
+static int read_pgm(T sudoku, FILE *fp)
+{
+    int magic = getc(fp);
+    int format = getc(fp);
+    assert (magic == 'P' && (format == '2' || format == '5'));
+
+    unsigned width = read_header_number(fp);
+    unsigned height = read_header_number(fp);
+    unsigned maxval = read_header_number(fp);
+
+    int box = 1;
+    while (box < MAX_BOX && (unsigned)(box * box) < width) {
+        box++;
+    }
+    int side = box * box;
+    assert ((unsigned)side == width && height == width && maxval == width);
+
+    int cells = side * side;
+    if (format == '5') {
+        size_t read = fread(sudoku->grid, 1, cells, fp);
+        assert (read == (size_t)cells);
+    } else {
+        read_plain_cells(fp, sudoku->grid, cells);
+    }
+
+    sudoku->box = box;
+    sudoku->side = side;
+
+    return check_any(sudoku->grid, box, side) < 0;
+}
+
+/* read_header_number
+ *    Purpose: Reads the width, height or maxval from a PGM header
+ * Parameters: the input stream
+ *    Returns: the number
+ *
+ *       Note: Whitespace and # comments before the number are skipped,
+ *             and the single whitespace character after it is consumed,
+ *             which is exactly what a raw raster expects after the
+ *             maxval.
+ */
+static unsigned read_header_number(FILE *fp)
+{
+    int c = getc(fp);
+
+    while (isspace(c) || c == '#') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = getc(fp);
+            }
+        }
+        c = getc(fp);
+    }
+
+    assert (isdigit(c));
+
+    unsigned number = 0;
+    while (isdigit(c)) {
+        assert (number <= (unsigned)(INT_MAX - 9) / 10);
+        number = number * 10 + (c - '0');
+        c = getc(fp);
+    }
+
+    assert (isspace(c));
+
+    return number;
+}
+
+/* read_plain_cells
+ *    Purpose: Reads the samples of a plain PGM raster into a grid
+ * Parameters: the input stream, the grid, and the number of cells
+ *    Returns: void
+ *
+ *       Note: Any byte at or below ' ' separates samples, and a byte
+ *             is a digit when it is below 10 after subtracting '0', so
+ *             a one-digit sample costs three comparisons and no calls.
+ *             Samples above 255 are stored as 255, which no grid
+ *             accepts.
+ */
+static void read_plain_cells(FILE *fp, uint8_t *grid, int cells)
+{
+    for (int cell = 0; cell < cells; cell++) {
+        int c = getc(fp);
+        while (c != EOF && c <= ' ') {
+            c = getc(fp);
+        }
+
+        unsigned digit = (unsigned)c - '0';
+        assert (digit < 10);
+
+        unsigned value = digit;
+        for (digit = (unsigned)(c = getc(fp)) - '0'; digit < 10;
+             digit = (unsigned)(c = getc(fp)) - '0') {
+            value = value > 255 ? value : value * 10 + digit;
+        }
+        assert (c == EOF || c <= ' ');
+
+        grid[cell] = value > 255 ? 255 : value;
+    }
+}
+
+/* read_compact
+ *    Purpose: Reads and checks one 81-digit puzzle
+ * Parameters: the Sudoku_T and the input stream
+ *    Returns: 1 if the puzzle is solved, and 0 otherwise
+ *
+ *       Note: The characters are read straight into the grid and
+ *             converted in place; those after the first bad cell are
+ *             converted by blank_dots but not checked.
+ */
+static int read_compact(T sudoku, FILE *fp)
+{
+    size_t read = fread(sudoku->grid, 1, CELLS, fp);
+    assert (read == CELLS);
+    sudoku->box = 3;
+    sudoku->side = SIDE;
+
+    Masks masks = { { 0 }, { 0 }, { 0 } };
+    int cell = 0;
+
+    for (int row = 0; row < SIDE; row++) {
+        int band = row / 3 * 3;
+
+        for (int col = 0; col < SIDE; col++, cell++) {
+            unsigned digit = sudoku->grid[cell] - '0';
+            sudoku->grid[cell] = digit;
+
+            if (!mark_digit(&masks, row, col, band + col / 3, digit)) {
+                blank_dots(sudoku->grid, cell);
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* mark_digit
+ *    Purpose: Records a digit in its row, column and box
+ * Parameters: the masks, the cell's row, column and box, and its digit
+ *    Returns: 1 if the digit is from 1 to 9 and new to all three units,
+ *             and 0 otherwise
+ */
+static inline int mark_digit(Masks *masks, int row, int col, int box,
+                             unsigned digit)
+{
+    /* a 0 wraps around, so one comparison rejects both ends */
+    if (digit - 1 >= SIDE) {
+        return 0;
+    }
+
+    uint16_t bit = 1u << digit;
+    if ((masks->rows[row] | masks->cols[col] | masks->boxes[box]) & bit) {
+        return 0;
+    }
+
+    masks->rows[row] |= bit;
+    masks->cols[col] |= bit;
+    masks->boxes[box] |= bit;
+
+    return 1;
+}
+
+/* fill_window
+ *    Purpose: Reads the next window of a batch and finds where each of
+ *             its puzzles starts
+ * Parameters: the Batch, the window to fill, and the window before it,
+ *             or NULL for the first
+ *    Returns: void
+ *
+ *       Note: Only whitespace is looked at here; the workers convert
+ *             and check the digits. A puzzle cut off by the end of the
+ *             buffer is carried over to the next window, and one cut
+ *             off by the end of the stream sets truncated. The window
+ *             comes back empty only at the end of the stream.
+ */
+static void fill_window(Batch *batch, Window *window, const Window *prev)
+{
+    size_t len = 0;
+    size_t pos = 0;
+    int n = 0;
+
+    if (prev != NULL) {
+        len = prev->leftover;
+        memcpy(window->raw, prev->raw + prev->raw_len - len, len);
+    }
+
+    for (;;) {
+        if (!batch->at_eof) {
+            len += fread(window->raw + len, 1, batch->raw_cap - len,
+                         batch->in);
+            batch->at_eof = len < batch->raw_cap;
+        }
+
+        const char *raw = window->raw;
+        while ((size_t)n < WINDOW_PUZZLES) {
+            while (pos < len && isspace((unsigned char)raw[pos])) {
+                pos++;
+            }
+            if (pos == len) {
+                break;
+            }
+            if (len - pos < CELLS) {
+                /* the stream may end only between puzzles */
+                batch->truncated |= batch->at_eof;
+                break;
+            }
+            window->starts[n++] = pos;
+            pos += CELLS;
+        }
+        if (n > 0 || batch->at_eof) {
+            break;
+        }
+
+        /* a buffer of nothing but whitespace, and perhaps the start of
+         * a puzzle: drop the whitespace and read on */
+        memmove(window->raw, window->raw + pos, len - pos);
+        len -= pos;
+        pos = 0;
+    }
+
+    window->raw_len = len;
+    window->num_puzzles = n;
+    window->leftover = batch->truncated ? 0 : len - pos;
+}
+
+/* write_window
+ *    Purpose: Writes the lines of a checked window and counts its
+ *             unsolved puzzles
+ * Parameters: the Batch and the window
+ *    Returns: void
+ */
+static void write_window(Batch *batch, const Window *window)
+{
+    for (int i = 0; i < window->num_puzzles; i++) {
+        batch->unsolved += !window->verdicts[i];
+        batch->lines[2 * i] = window->verdicts[i] ? '0' : '1';
+        batch->lines[2 * i + 1] = '\n';
+    }
+
+    size_t written = fwrite(batch->lines, 2, window->num_puzzles,
+                            batch->out);
+    batch->write_failed |= written != (size_t)window->num_puzzles;
+}
+
+/* run_stage
+ *    Purpose: Runs one job of a batch round: job 0 writes the window
+ *             checked last round and reads the next into its buffers,
+ *             and every other job checks a chunk of this round's window
+ * Parameters: the worker running the job, the job's index, and the
+ *             Batch
+ *    Returns: void
+ *
+ *       Note: The next window's carried-over bytes lie past the last
+ *             puzzle of this one, so the reader and the checkers never
+ *             touch the same bytes.
+ */
+static void run_stage(int worker, int job, void *cl)
+{
+    Batch *batch = cl;
+
+    if (job > 0) {
+        check_chunk(batch, worker, job - 1);
+        return;
+    }
+
+    if (batch->other_checked) {
+        write_window(batch, batch->other);
+    }
+    fill_window(batch, batch->other, batch->checking);
+}
+
+/* check_chunk
+ *    Purpose: Converts and checks one chunk of the window being checked
+ * Parameters: the Batch, the worker running the chunk, and the chunk's
+ *             index
+ *    Returns: void
+ *
+ *       Note: Each worker converts into its own scratch grids, and the
+ *             verdicts land in the chunk's own slots, so workers never
+ *             share anything they write.
+ */
+static void check_chunk(Batch *batch, int worker, int chunk)
+{
+    const Window *window = batch->checking;
+    int first = chunk * BATCH_CHUNK;
+    int count = window->num_puzzles - first;
+    if (count > BATCH_CHUNK) {
+        count = BATCH_CHUNK;
+    }
+
+    uint8_t *grids = batch->scratch + (size_t)worker * BATCH_CHUNK * CELLS;
+    for (int i = 0; i < count; i++) {
+        const char *puzzle = window->raw + window->starts[first + i];
+        uint8_t *grid = grids + (size_t)i * CELLS;
+
+        /* anything below '0' wraps around to a large, invalid digit */
+        for (int k = 0; k < CELLS; k++) {
+            grid[k] = (uint8_t)(puzzle[k] - '0');
+        }
+    }
+
+    Sudoku_check_grids(grids, count, window->verdicts + first,
+                       Sudoku_BEST);
+}
+
+/* blank_dots
+ *    Purpose: Finishes converting a compact puzzle after its first bad
+ *             cell
+ * Parameters: the grid, converted up to and including that cell
+ *    Returns: void
+ *
+ *       Note: A '.' is the usual blank in compact puzzle files, so it
+ *             becomes 0 like a '0' does; this is off the path of valid
+ *             puzzles.
+ */
+static void blank_dots(uint8_t *grid, int cell)
+{
+    const uint8_t dot = (uint8_t)('.' - '0');
+
+    grid[cell] = grid[cell] == dot ? 0 : grid[cell];
+    for (cell++; cell < CELLS; cell++) {
+        grid[cell] = grid[cell] == '.' ? 0 : (uint8_t)(grid[cell] - '0');
+    }
+}
+
+/* load_board
+ *    Purpose: Sets up a Board from a grid with blanks
+ * Parameters: the Board and the grid, 0 for a blank
+ *    Returns: 1 if the given digits break no rule, and 0 otherwise
+ */
+static int load_board(Board *board, const uint8_t *grid)
+{
+    memset(board, 0, sizeof(*board));
+    board->blanks = CELLS;
+
+    for (int cell = 0; cell < CELLS; cell++) {
+        int digit = grid[cell];
+
+        if (digit == 0) {
+            continue;
+        }
+        if (digit > SIDE) {
+            return 0;
+        }
+
+        uint16_t bit = 1u << digit;
+        if (!(candidates(board, cell) & bit)) {
+            return 0;
+        }
+        place(board, cell, bit);
+    }
+
+    return 1;
+}
+
+/* candidates
+ *    Purpose: Finds the digits a cell could still hold
+ * Parameters: the Board and the cell
+ *    Returns: the mask of digits missing from the cell's row, column and
+ *             box
+ */
+static inline uint16_t candidates(const Board *board, int cell)
+{
+    const uint8_t *units = cell_units[cell];
+    uint16_t used = board->rows[units[0]] | board->cols[units[1]]
+                    | board->boxes[units[2]];
+
+    return ~used & ALL_DIGITS;
+}
+
+/* place
+ *    Purpose: Writes a digit into a cell and its row, column and box
+ * Parameters: the Board, the cell, and the digit's bit
+ *    Returns: void
+ */
+static inline void place(Board *board, int cell, uint16_t bit)
+{
+    const uint8_t *units = cell_units[cell];
+
+    board->cells[cell] = __builtin_ctz(bit);
+    board->rows[units[0]] |= bit;
+    board->cols[units[1]] |= bit;
+    board->boxes[units[2]] |= bit;
+    board->blanks--;
+}
+
+/* propagate
+ *    Purpose: Fills in every naked and hidden single until none is left
+ * Parameters: the Board
+ *    Returns: 0 if a cell or a digit of some unit has no place left, and
+ *             1 otherwise
+ *
+ *       Note: A naked single is a blank with one candidate; a hidden
+ *             single is a digit that fits only one blank of a unit.
+ */
+static int propagate(Board *board)
+{
+    int progress = 1;
+
+    while (progress && board->blanks > 0) {
+        progress = 0;
+
+        /* candidates as of the start of this round; placements made
+         * during the round only shrink them, so each is rechecked
+         * before it is used to place a digit */
+        uint16_t cand[CELLS];
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            cand[cell] = 0;
+            if (board->cells[cell] != 0) {
+                continue;
+            }
+
+            uint16_t mask = candidates(board, cell);
+            if (mask == 0) {
+                return 0;
+            }
+            if ((mask & (mask - 1)) == 0) {
+                place(board, cell, mask);
+                progress = 1;
+            } else {
+                cand[cell] = mask;
+            }
+        }
+
+        for (int unit = 0; unit < 3 * SIDE; unit++) {
+            const uint8_t *cells = unit_cells[unit];
+            uint16_t once = 0;
+            uint16_t twice = 0;
+            uint16_t placed = 0;
+
+            for (int k = 0; k < SIDE; k++) {
+                uint16_t mask = cand[cells[k]];
+                placed |= 1u << board->cells[cells[k]];
+                twice |= once & mask;
+                once |= mask;
+            }
+            placed &= ALL_DIGITS;
+            if ((once | placed) != ALL_DIGITS) {
+                return 0;
+            }
+
+            for (uint16_t singles = once & ~twice & ~placed; singles != 0;
+                 singles &= singles - 1) {
+                uint16_t bit = singles & -singles;
+
+                for (int k = 0; k < SIDE; k++) {
+                    int cell = cells[k];
+                    if (cand[cell] & bit) {
+                        if (board->cells[cell] == 0
+                            && (candidates(board, cell) & bit)) {
+                            place(board, cell, bit);
+                            progress = 1;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* search
+ *    Purpose: Solves a Board by propagation and backtracking
+ * Parameters: the Search and the Board, which is changed
+ *    Returns: 1 once the Search has found its limit of solutions, and 0
+ *             otherwise
+ *
+ *       Note: Each guess goes into the blank with the fewest candidates,
+ *             on a copy of the Board, so backing out is free.
+ */
+static int search(Search *state, Board *board)
+{
+    if (!propagate(board)) {
+        return 0;
+    }
+    if (board->blanks == 0) {
+        if (state->found++ == 0) {
+            memcpy(state->solution, board->cells, CELLS);
+        }
+        return state->found >= state->limit;
+    }
+
+    int best = -1;
+    int fewest = SIDE + 1;
+    for (int cell = 0; cell < CELLS && fewest > 2; cell++) {
+        if (board->cells[cell] == 0) {
+            int count = __builtin_popcount(candidates(board, cell));
+            if (count < fewest) {
+                fewest = count;
+                best = cell;
+            }
+        }
+    }
+
+    for (uint16_t cand = candidates(board, best); cand != 0;
+         cand &= cand - 1) {
+        Board next = *board;
+        place(&next, best, cand & -cand);
+        if (search(state, &next)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* The common sizes: 4 x 4, 9 x 9, 16 x 16 and 25 x 25 */
+CHECK_KERNEL(2, uint8_t)
+CHECK_KERNEL(3, uint16_t)
+CHECK_KERNEL(4, uint16_t)
+CHECK_KERNEL(5, uint32_t)
+
+/* check_general
+ *    Purpose: Checks a grid of any supported size
+ * Parameters: the grid, row by row, the side of its boxes, and the
+ *             distance between its rows in bytes
+ *    Returns: the row-major index of the first bad cell, or -1 if the
+ *             grid is solved
+ *
+ *       Note: The same rule as the CHECK_KERNEL functions, with the box
+ *             size known only at run time.
+ */
+static int check_general(const uint8_t *grid, int box, size_t stride)
+{
+    const int side = box * box;
+    uint64_t rows[MAX_SIDE] = { 0 };
+    uint64_t cols[MAX_SIDE] = { 0 };
+    uint64_t boxes[MAX_SIDE] = { 0 };
+
+    for (int row = 0; row < side; row++, grid += stride) {
+        int band = row / box * box;
+
+        for (int col = 0; col < side; col++) {
+            unsigned digit = grid[col] - 1u;
+            int unit = band + col / box;
+            if (digit >= (unsigned)side) {
+                return row * side + col;
+            }
+
+            uint64_t bit = (uint64_t)1 << digit;
+            if ((rows[row] | cols[col] | boxes[unit]) & bit) {
+                return row * side + col;
+            }
+            rows[row] |= bit;
+            cols[col] |= bit;
+            boxes[unit] |= bit;
+        }
+    }
+
+    return -1;
+}
+
+/* check_any
+ *    Purpose: Checks a grid with the kernel for its size
+ * Parameters: the grid, row by row, the side of its boxes, and the
+ *             distance between its rows in bytes
+ *    Returns: the row-major index of the first bad cell, or -1 if the
+ *             grid is solved
+ */
+static int check_any(const uint8_t *grid, int box, size_t stride)
+{
+    switch (box) {
+    case 2:
+        return check_box2(grid, stride);
+    case 3:
+        return check_box3(grid, stride);
+    case 4:
+        return check_box4(grid, stride);
+    case 5:
+        return check_box5(grid, stride);
+    default:
+        return check_general(grid, box, stride);
+    }
+}
+
+/* find_conflict
+ *    Purpose: Finds which rule the first bad cell of a grid breaks
+ * Parameters: the grid, the side of its boxes, the distance between its
+ *             rows, and the row and column of the cell
+ *    Returns: Sudoku_DIGIT if the cell is out of range, or else the
+ *             first of Sudoku_ROW, Sudoku_COL and Sudoku_BOX whose
+ *             earlier cells already hold its digit
+ *
+ *       Note: Only called once a kernel has stopped, so every earlier
+ *             cell is known to be good.
+ */
+static Sudoku_unit find_conflict(const uint8_t *grid, int box,
+                                 size_t stride, int row, int col)
+{
+    int side = box * box;
+    int digit = grid[row * stride + col];
+
+    if (digit < 1 || digit > side) {
+        return Sudoku_DIGIT;
+    }
+    for (int c = 0; c < col; c++) {
+        if (grid[row * stride + c] == digit) {
+            return Sudoku_ROW;
+        }
+    }
+    for (int r = 0; r < row; r++) {
+        if (grid[r * stride + col] == digit) {
+            return Sudoku_COL;
+        }
+    }
+
+    return Sudoku_BOX;
+}
+
+#if SUDOKU_SIMD
+
+/* load_block_sse2
+ *    Purpose: Transposes 16 grids so that each vector holds one cell of
+ *             every grid
+ * Parameters: the 16 grids, 81 digits each, and the array for the cells
+ *    Returns: void
+ *
+ *       Note: The grids are transposed 16 bytes at a time, at offsets
+ *             0, 16, ..., 64 and finally 65 so that no load runs past
+ *             the last grid. Four rounds of unpacks leave cell j of the
+ *             16 in vector j with its four bits reversed.
+ */
+static void load_block_sse2(const uint8_t *grids, __m128i cells[CELLS])
+{
+    static const int offsets[] = { 0, 16, 32, 48, 64, CELLS - 16 };
+    static const int reversed[16] = { 0, 8, 4, 12, 2, 10, 6, 14,
+                                      1, 9, 5, 13, 3, 11, 7, 15 };
+
+    for (int o = 0; o < 6; o++) {
+        __m128i x[16];
+        __m128i y[16];
+
+        for (int g = 0; g < 16; g++) {
+            x[g] = _mm_loadu_si128((const __m128i *)(grids + g * CELLS
+                                                     + offsets[o]));
+        }
+        for (int i = 0; i < 8; i++) {
+            y[i] = _mm_unpacklo_epi8(x[2 * i], x[2 * i + 1]);
+            y[i + 8] = _mm_unpackhi_epi8(x[2 * i], x[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; i++) {
+            x[i] = _mm_unpacklo_epi16(y[2 * i], y[2 * i + 1]);
+            x[i + 8] = _mm_unpackhi_epi16(y[2 * i], y[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; i++) {
+            y[i] = _mm_unpacklo_epi32(x[2 * i], x[2 * i + 1]);
+            y[i + 8] = _mm_unpackhi_epi32(x[2 * i], x[2 * i + 1]);
+        }
+        for (int i = 0; i < 8; i++) {
+            x[i] = _mm_unpacklo_epi64(y[2 * i], y[2 * i + 1]);
+            x[i + 8] = _mm_unpackhi_epi64(y[2 * i], y[2 * i + 1]);
+        }
+        for (int i = 0; i < 16; i++) {
+            cells[offsets[o] + reversed[i]] = x[i];
+        }
+    }
+}
+
+/* check_block_sse2
+ *    Purpose: Checks 16 grids at once, one per byte lane
+ * Parameters: the 16 grids, 81 digits each
+ *    Returns: a mask with bit k set if grid k is solved
+ *
+ *       Note: SSE2 has no byte shuffle to turn a digit into its bit, so
+ *             instead every cell is tested to be 1-9 and the nine cells
+ *             of each unit are compared pairwise. Nine digits from 1 to
+ *             9 with no two equal are a solved unit. A lane's bad byte
+ *             becomes nonzero on its first failure.
+ */
+static unsigned check_block_sse2(const uint8_t *grids)
+{
+    __m128i cells[CELLS];
+    load_block_sse2(grids, cells);
+
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i eight = _mm_set1_epi8(8);
+    __m128i bad = _mm_setzero_si128();
+
+    /* digit - 1 is unchanged by min(digit - 1, 8) only for 1 to 9 */
+    for (int i = 0; i < CELLS; i++) {
+        __m128i digit = _mm_sub_epi8(cells[i], one);
+        bad = _mm_or_si128(bad, _mm_xor_si128(digit,
+                                              _mm_min_epu8(digit, eight)));
+    }
+
+    for (int u = 0; u < 3 * SIDE; u++) {
+        __m128i unit[SIDE];
+        UNROLL
+        for (int k = 0; k < SIDE; k++) {
+            unit[k] = cells[unit_cells[u][k]];
+        }
+
+        /* one running OR per cell keeps the dependency chains short */
+        UNROLL
+        for (int a = 0; a < SIDE - 1; a++) {
+            __m128i same = _mm_cmpeq_epi8(unit[a], unit[a + 1]);
+            UNROLL
+            for (int b = a + 2; b < SIDE; b++) {
+                same = _mm_or_si128(same, _mm_cmpeq_epi8(unit[a], unit[b]));
+            }
+            bad = _mm_or_si128(bad, same);
+        }
+    }
+
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bad,
+                                                      _mm_setzero_si128()));
+}
+
+/* check_block_avx2
+ *    Purpose: Checks 32 grids at once, one per byte lane
+ * Parameters: the 32 grids, 81 digits each
+ *    Returns: a mask with bit k set if grid k is solved
+ *
+ *       Note: Each cell becomes a low byte with bit d - 1 set for digits
+ *             1 to 8 and a high byte set to 1 for a 9, from two
+ *             byte-shuffle table lookups, with digits above 15 clamped
+ *             onto an empty table entry. A unit of nine cells is solved
+ *             exactly when the OR of its bits is 0xff and 1, so a repeat
+ *             or a digit outside 1-9 always leaves a bit clear.
+ */
+AVX2_TARGET static unsigned check_block_avx2(const uint8_t *grids)
+{
+    __m128i low[CELLS];
+    __m128i high[CELLS];
+    load_block_sse2(grids, low);
+    load_block_sse2(grids + 16 * CELLS, high);
+
+    const __m256i lo_table = _mm256_setr_epi8(
+        0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0,
+        0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i hi_table = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0);
+    const __m256i fifteen = _mm256_set1_epi8(15);
+    const __m256i full = _mm256_set1_epi8((char)0xff);
+    const __m256i one = _mm256_set1_epi8(1);
+    __m256i ok = full;
+    __m256i col_lo[SIDE];
+    __m256i col_hi[SIDE];
+
+    for (int col = 0; col < SIDE; col++) {
+        col_lo[col] = col_hi[col] = _mm256_setzero_si256();
+    }
+
+    for (int band = 0; band < SIDE; band += 3) {
+        __m256i box_lo[3];
+        __m256i box_hi[3];
+        for (int b = 0; b < 3; b++) {
+            box_lo[b] = box_hi[b] = _mm256_setzero_si256();
+        }
+
+        for (int row = band; row < band + 3; row++) {
+            __m256i row_lo = _mm256_setzero_si256();
+            __m256i row_hi = _mm256_setzero_si256();
+
+            for (int col = 0; col < SIDE; col++) {
+                int i = row * SIDE + col;
+                __m256i cell = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(low[i]), high[i], 1);
+                cell = _mm256_min_epu8(cell, fifteen);
+                __m256i lo = _mm256_shuffle_epi8(lo_table, cell);
+                __m256i hi = _mm256_shuffle_epi8(hi_table, cell);
+
+                row_lo = _mm256_or_si256(row_lo, lo);
+                row_hi = _mm256_or_si256(row_hi, hi);
+                col_lo[col] = _mm256_or_si256(col_lo[col], lo);
+                col_hi[col] = _mm256_or_si256(col_hi[col], hi);
+                box_lo[col / 3] = _mm256_or_si256(box_lo[col / 3], lo);
+                box_hi[col / 3] = _mm256_or_si256(box_hi[col / 3], hi);
+            }
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(row_lo, full));
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(row_hi, one));
+        }
+        for (int b = 0; b < 3; b++) {
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(box_lo[b], full));
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(box_hi[b], one));
+        }
+    }
+    for (int col = 0; col < SIDE; col++) {
+        ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(col_lo[col], full));
+        ok = _mm256_and_si256(ok, _mm256_cmpeq_epi8(col_hi[col], one));
+    }
+
+    return (unsigned)_mm256_movemask_epi8(ok);
+}
+
+#endif /* SUDOKU_SIMD */
@@ -0,0 +1,235 @@
+/**************************************************************
+ *
+ *                     sudokucheck.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     The Sudoku interface reads sudoku solutions and checks them,
+ *     either one at a time or as a stream of many. Grids are N*N
+ *     by N*N with N-by-N boxes, for N up to 8; the usual puzzle is
+ *     N = 3, and 4 x 4, 16 x 16 and 25 x 25 get kernels of their
+ *     own.
+ *     A Sudoku_T holds the grid for one puzzle; a caller checking a
+ *     stream creates one Sudoku_T and reuses it for every puzzle.
+ *     Each puzzle is checked while it is read, and the check
+ *     allocates nothing.
+ *
+ *     Streams come in two formats: concatenated PGMs (P2 or P5,
+ *     N*N by N*N with maxval N*N, so the size is read from each
+ *     header), or the compact format of 81 digits per nine-by-nine
+ *     puzzle, row by row, each puzzle optionally followed by a
+ *     newline.
+ *
+ **************************************************************/
+
+#ifndef __SUDOKUCHECK__
+#define __SUDOKUCHECK__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#define T Sudoku_T
+
+typedef struct T *T;
+
+/* How puzzles are written in a stream */
+typedef enum {
+    Sudoku_PGM,             /* one P2 or P5 graymap per puzzle */
+    Sudoku_COMPACT          /* 81 digits per puzzle */
+} Sudoku_format;
+
+/* The ways Sudoku_check_grids can check a block of grids */
+typedef enum {
+    Sudoku_BEST,            /* the widest kernel this machine runs */
+    Sudoku_SCALAR,          /* one grid at a time, with digit masks */
+    Sudoku_SSE2,            /* 16 grids at a time */
+    Sudoku_AVX2             /* 32 grids at a time */
+} Sudoku_kernel;
+
+/* The rule the first bad cell of a grid breaks */
+typedef enum {
+    Sudoku_NONE,            /* the grid is solved */
+    Sudoku_ROW,             /* its digit is already in its row */
+    Sudoku_COL,             /* ... in its column */
+    Sudoku_BOX,             /* ... in its box */
+    Sudoku_DIGIT            /* it is not a digit from 1 to N*N */
+} Sudoku_unit;
+
+/* What Sudoku_validate found */
+typedef struct Sudoku_result {
+    int valid;              /* 1 if the grid is solved */
+    Sudoku_unit unit;       /* the rule broken first */
+    int index;              /* that row, column or box; for a bad digit,
+                               the cell's row-major index */
+    int row;                /* the first bad cell, or -1 */
+    int col;
+} Sudoku_result;
+
+/* Sudoku_new
+ * Purpose: Creates the grid for checking puzzles
+ * Parameters: none
+ * Returns: the new Sudoku_T
+ * Expected input: none
+ * Success output: a Sudoku_T ready for Sudoku_read
+ * Failure output: if memory cannot be allocated, a Hanson CRE is raised
+ */
+T Sudoku_new(void);
+
+/* Sudoku_read
+ * Purpose: Reads the next puzzle of a stream into a Sudoku_T and checks
+ *          it
+ * Parameters: the Sudoku_T, a file pointer for the input stream, and the
+ *             Sudoku_format of the stream
+ * Returns: 1 if a puzzle was read, or 0 if the stream was at its end
+ * Expected input: a valid Sudoku_T and a stream positioned at the start
+ *                 of a puzzle or at whitespace before the end
+ * Success output: the puzzle replaces the previous one; cells that are
+ *                 not digits from 1 to N*N make it invalid, but are not
+ *                 errors. Checking stops at the first bad cell
+ * Failure output: if the Sudoku_T or stream is null, if a PGM header is
+ *                 not N*N by N*N with maxval N*N for some N from 1 to 8,
+ *                 or if the stream ends in the middle of a puzzle, a
+ *                 Hanson CRE is raised
+ */
+int Sudoku_read(T sudoku, FILE *fp, Sudoku_format format);
+
+/* Sudoku_check
+ * Purpose: Reports whether the puzzle last read is a solved sudoku
+ * Parameters: the Sudoku_T
+ * Returns: 1 if the puzzle is solved, and 0 otherwise
+ * Expected input: a Sudoku_T holding a puzzle
+ * Success output: 1 when every cell is a digit from 1 to N*N and no
+ *                 digit appears twice in a row, column or N-by-N box
+ * Failure output: if the Sudoku_T is null or holds no puzzle, a Hanson
+ *                 CRE is raised
+ */
+int Sudoku_check(T sudoku);
+
+/* Sudoku_validate
+ * Purpose: Checks an in-memory grid and reports where it first goes
+ *          wrong, without allocating, printing or needing a Sudoku_T
+ * Parameters: a pointer to the first cell, the side N of the grid's
+ *             boxes, and the distance between the starts of its rows in
+ *             bytes; a plain uint8_t[81] is box 3, stride 9
+ * Returns: a Sudoku_result
+ * Expected input: N*N rows of N*N digits as numbers, each row stride
+ *                 bytes after the last; N from 1 to 8
+ * Success output: valid is 1 and unit Sudoku_NONE if the grid is solved.
+ *                 Otherwise row and col give the first cell, in row-major
+ *                 order, that repeats a digit or is out of range, and
+ *                 unit and index say which row, column or box it repeats
+ *                 in, checking in that order
+ * Failure output: if the grid is null, the box size is out of range or
+ *                 the stride is shorter than a row, a Hanson CRE is
+ *                 raised
+ */
+Sudoku_result Sudoku_validate(const uint8_t *grid, int box, size_t stride);
+
+/* Sudoku_has_kernel
+ * Purpose: Reports whether a Sudoku_kernel can run on this machine
+ * Parameters: the Sudoku_kernel
+ * Returns: 1 if it can, and 0 otherwise
+ * Expected input: any Sudoku_kernel
+ * Success output: 1 for Sudoku_BEST and Sudoku_SCALAR; the vector
+ *                 kernels need an x86-64 build, and Sudoku_AVX2 also
+ *                 needs a CPU that has AVX2
+ * Failure output: none
+ */
+int Sudoku_has_kernel(Sudoku_kernel kernel);
+
+/* Sudoku_check_grids
+ * Purpose: Checks many in-memory grids, several at a time in the lanes
+ *          of vector registers
+ * Parameters: the grids, 81 digits each row by row and one after the
+ *             other, the number of grids, an array with room for one
+ *             verdict per grid, and the Sudoku_kernel to use
+ * Returns: the number of solved grids
+ * Expected input: digits as numbers, not characters; count may be 0
+ * Success output: solved[i] is 1 if grid i is solved and 0 otherwise,
+ *                 by the same rule as Sudoku_check. Grids left over
+ *                 after the last full block are checked one at a time
+ * Failure output: if either array is null, the count is negative or the
+ *                 kernel cannot run here, a Hanson CRE is raised
+ */
+int Sudoku_check_grids(const uint8_t *grids, int count, uint8_t *solved,
+                       Sudoku_kernel kernel);
+
+/* The most threads Sudoku_batch runs; larger counts are lowered to it */
+#define SUDOKU_MAX_THREADS 32
+
+/* Sudoku_batch
+ * Purpose: Checks a stream of compact puzzles on several threads,
+ *          writing one line per puzzle in input order
+ * Parameters: the input stream, the output stream, and the number of
+ *             threads (0 means one per processor, and at most
+ *             SUDOKU_MAX_THREADS are used)
+ * Returns: the number of puzzles that are not solved
+ * Expected input: a compact stream as read by Sudoku_read
+ * Success output: a line per puzzle, 0 if it is solved and 1 if not,
+ *                 in the order the puzzles were read
+ * Failure output: if a stream is null, the thread count is negative,
+ *                 memory cannot be allocated or the input ends in the
+ *                 middle of a puzzle, a Hanson CRE is raised
+ *           Note: Puzzles are read in windows of a fixed number of
+ *                 chunks; threads claim chunks as they free up and
+ *                 check them with Sudoku_check_grids. Two windows take
+ *                 turns, so one thread writes the last window's lines
+ *                 and reads the next window while the rest check this
+ *                 one. Memory is allocated once per call, not per
+ *                 puzzle.
+ */
+int Sudoku_batch(FILE *in, FILE *out, int num_threads);
+
+/* Sudoku_solve
+ * Purpose: Fills in the blanks of the puzzle last read
+ * Parameters: the Sudoku_T and the most solutions to look for: 1 to just
+ *             solve, 2 to also learn whether the solution is unique
+ * Returns: the number of solutions found, at most limit
+ * Expected input: a Sudoku_T holding a nine-by-nine puzzle in which 0
+ *                 cells are blanks (a '.' is also a blank in compact
+ *                 input)
+ * Success output: if a solution is found, it replaces the grid and
+ *                 Sudoku_check reports 1; otherwise the grid is left
+ *                 as it was read. Puzzles whose given digits already
+ *                 break a rule, or hold cells above 9, have none
+ * Failure output: if the Sudoku_T is null or holds no nine-by-nine
+ *                 puzzle, or the limit is below 1, a Hanson CRE is
+ *                 raised
+ *           Note: Blanks with a single candidate and digits that fit a
+ *                 single blank of a row, column or box are filled in
+ *                 first; the search guesses only when neither is left.
+ */
+int Sudoku_solve(T sudoku, int limit);
+
+/* Sudoku_write
+ * Purpose: Writes the grid of a Sudoku_T to a stream
+ * Parameters: the Sudoku_T, the output stream, and the Sudoku_format to
+ *             write it in
+ * Returns: none
+ * Expected input: a Sudoku_T holding a puzzle and a writable stream
+ * Success output: a plain (P2) PGM of the puzzle's size, or a compact
+ *                 line of 81 digits; blanks are written as 0
+ * Failure output: if the Sudoku_T or stream is null, the Sudoku_T holds
+ *                 no puzzle, a compact line is asked for a puzzle that
+ *                 is not nine by nine, or the write fails, a Hanson CRE
+ *                 is raised
+ */
+void Sudoku_write(T sudoku, FILE *fp, Sudoku_format format);
+
+/* Sudoku_free
+ * Purpose: Frees a Sudoku_T
+ * Parameters: a pointer to the Sudoku_T
+ * Returns: none
+ * Expected input: non-null pointer to a valid Sudoku_T
+ * Success output: the Sudoku_T is set to NULL
+ * Failure output: if either the pointer or the Sudoku_T itself are null,
+ *                 a Hanson CRE is raised
+ */
+void Sudoku_free(T *sudoku);
+
+#undef T
+#endif /* __SUDOKUCHECK__ */
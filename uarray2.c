@@ -7,23 +7,119 @@
  *     Date:     Oct 4, 2021
  *
  *     Summary
- *     
+ *       Implementation of the UArray2 interface. The struct and all
+ *       of the elements live in one allocation: the header comes
+ *       first and the elements follow, starting on a 64-byte
+ *       boundary. In column-major and row-major storage element
+ *       (col, row) is at elems + col * col_stride + row * row_stride,
+ *       and each column (or row) is padded to a multiple of
+ *       UARRAY2_ALIGN bytes so that every one starts aligned.
+ *       Blocked storage pads the array to whole blocks, stores the
+ *       blocks in row-major order and the elements of each block in
+ *       row-major order, and uses shifts and masks to find them.
+ *       File-backed arrays keep the struct on its own and map an
+ *       arrayfile, using its payload as the elements in place.
+ *
  **************************************************************/
 
+/* mmap, msync and posix_madvise are POSIX, not C99 */
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <uarray2.h>
+#include <parallel.h>
+#include <arrayfile.h>
 
 #define T UArray2_T
 
+/* Blocks of UArray2_BLOCKED storage hold at most this many bytes */
+#define BLOCK_BYTES 4096
+
+/* Default tiles of UArray2_map_block_major hold at most this many bytes:
+ * half of a typical 32 KB L1 data cache, leaving room for the rows or
+ * columns next to the tile that a stencil also reads */
+#define TILE_BYTES (16 * 1024)
+
+/* UArray2_reduce_parallel hands out about this many elements at a time */
+#define CHUNK_ELEMS 16384
+
+/* UArray2_transpose stops splitting at tiles this many elements on a
+ * side: two 32 x 32 tiles of 8-byte elements fill half of a 32 KB L1 */
+#define TRANSPOSE_SIDE 32
+
 struct T {
-    UArray_T col_uarray;
+    char *elems;
+    size_t elems_size;
     int width;
     int height;
     size_t size;
+    UArray2_order order;
+    size_t col_stride;      /* column-major and row-major storage */
+    size_t row_stride;
+    int block_shift;        /* blocked storage: log2 of the block side */
+    int blocks_wide;
+    int blocks_high;
+    size_t block_bytes;
+    int pooled;             /* storage belongs to a Pool */
+    int is_view;            /* elems belong to another UArray2 */
+    char *map;              /* start of the file mapping, or NULL */
+    size_t map_bytes;
+    int map_writable;
 };
 
+/* Shared state handed to every worker of UArray2_map_parallel */
+typedef struct MapParallelData {
+    T uarray2;
+    void (*apply)(int col, int row, T a, void *p1, void *p2);
+    void *cl;
+    size_t cl_size;
+    char *thread_cls;
+    int units_per_chunk;
+} MapParallelData;
+
+static T new_array(int width, int height, size_t size,
+                   UArray2_order order, int block_shift, Pool_T pool);
+static inline char *element_at(T uarray2, int col, int row);
+static int outer_count(T uarray2);
+static void map_range(T uarray2, int lo, int hi,
+                      void apply(int col, int row, T a, void *p1, void *p2),
+                      void *cl);
+/* Shared state handed to every worker of UArray2_reduce_parallel */
+typedef struct ReduceData {
+    T uarray2;
+    void (*apply)(int col, int row, T a, void *p1, void *p2);
+    int units_per_chunk;
+    size_t result_size;
+    char *partials;
+} ReduceData;
+
+static int chunk_units(T uarray2);
+static void map_parallel_chunk(int worker, int chunk, void *cl);
+static void reduce_chunk(int worker, int chunk, void *cl);
+static size_t padded_line(size_t bytes);
+static void set_shape(T uarray2, int width, int height, size_t size,
+                      UArray2_order order, int block_shift);
+static int default_block_shift(size_t size);
+static void fill_header(T uarray2, ArrayFile_header *header);
+static UArray2_order header_order(ArrayFile_header *header,
+                                  int *block_shift);
+static T map_file(int fd, ArrayFile_header *header, int writable);
+static void transpose_range(T dst, T src, int col, int row, int cols,
+                            int rows);
+static void transpose_tile(T dst, T src, int col, int row, int cols,
+                           int rows);
+static void swap_tile(T uarray2, int col, int row, int cols, int rows);
+static void gather_line(T uarray2, int line, char *buf);
+
 /* UArray2_new
  * Purpose: Creates a new UArray2 of a given width and height that
  *          can store elements of the given size.
@@ -37,28 +133,42 @@ struct T {
  *                 is raised
  */
 T UArray2_new(int width, int height, size_t size){
-    assert (width > 0 && height > 0);
-    assert (size > 0);
-    
-    T new_uarray2 = malloc(sizeof(struct T));
-    assert (new_uarray2 != NULL);
+    return UArray2_new_order(width, height, size, UArray2_COL_MAJOR);
+}
 
-    new_uarray2->width = width;
-    new_uarray2->height = height;
-    new_uarray2->size = size;
+/* UArray2_new_order
+ * Purpose: Creates a new UArray2 whose elements are stored in a chosen
+ *          order
+ * Parameters: the width, height and element size, and the UArray2_order
+ * Returns: the new UArray2
+ * Expected input: a width, height, and size that are all greater than 0
+ *                 and one of the UArray2_order values
+ * Success output: a new UArray2 is returned
+ * Failure output: if the width, height, size or order are invalid, a
+ *                 Hanson CRE is raised
+ */
+T UArray2_new_order(int width, int height, size_t size, UArray2_order order)
+{
+    return UArray2_new_pool(width, height, size, order, NULL);
+}
 
-    UArray_T col_uarray = UArray_new(width, sizeof(UArray_T));
-    assert (col_uarray != NULL);
-    
-    for (int i = 0; i < width; i++) {
-        UArray_T *empty_uarray = UArray_at(col_uarray, i);
-        UArray_T row_uarray = UArray_new(height, size);
-        *empty_uarray = row_uarray;
-    }
-    
-    new_uarray2->col_uarray = col_uarray;
-    
-    return new_uarray2;
+/* UArray2_new_pool
+ * Purpose: Creates a new UArray2 whose storage comes from a Pool
+ * Parameters: the width, height, element size, UArray2_order, and the
+ *             Pool (or NULL for the heap)
+ * Returns: the new UArray2
+ * Expected input: the same as UArray2_new_order
+ * Success output: a new, zero-filled UArray2 is returned
+ * Failure output: if the width, height, size or order are invalid, a
+ *                 Hanson CRE is raised
+ */
+T UArray2_new_pool(int width, int height, size_t size, UArray2_order order,
+                   Pool_T pool)
+{
+    assert (size > 0);
+
+    return new_array(width, height, size, order, default_block_shift(size),
+                     pool);
 }
 
 /* UArray2_at
@@ -77,11 +187,66 @@ void *UArray2_at(T uarray2, int col, int row){
     assert (col < uarray2->width && col >= 0);
     assert (row < uarray2->height && row >= 0);
     
-    UArray_T curr_column = *(UArray_T *)UArray_at(uarray2->col_uarray, col);
-
-    return UArray_at(curr_column, row);
+    return element_at(uarray2, col, row);
 }
     
+/* UArray2_view
+ * Purpose: Creates a view onto a rectangle of an existing UArray2
+ * Parameters: the parent UArray2, the column and row of the rectangle's
+ *             top left element, and its width and height
+ * Returns: the new view
+ * Expected input: a valid UArray2 that is not blocked and a rectangle
+ *                 inside it
+ * Success output: a UArray2 whose element (0, 0) is the parent's element
+ *                 (col, row)
+ * Failure output: if the parent is null or blocked, or the rectangle
+ *                 does not fit, a Hanson CRE is raised
+ */
+T UArray2_view(T parent, int col, int row, int width, int height)
+{
+    return UArray2_view_strided(parent, col, row, width, height, 1, 1);
+}
+
+/* UArray2_view_strided
+ * Purpose: Creates a view onto every col_step-th column and row_step-th
+ *          row of a rectangle of an existing UArray2
+ * Parameters: the parent UArray2, the column and row of the view's
+ *             element (0, 0) in the parent, the view's width and height,
+ *             and the column and row steps
+ * Returns: the new view
+ * Expected input: a valid UArray2 that is not blocked, positive steps,
+ *                 and a view whose last element is inside the parent
+ * Success output: a UArray2 whose element (c, r) is the parent's element
+ *                 (col + c * col_step, row + r * row_step)
+ * Failure output: if the parent is null or blocked, or the view does not
+ *                 fit, a Hanson CRE is raised
+ */
+T UArray2_view_strided(T parent, int col, int row, int width, int height,
+                       int col_step, int row_step)
+{
+    assert (parent != NULL && parent->order != UArray2_BLOCKED);
+    assert (width > 0 && height > 0 && col_step > 0 && row_step > 0);
+    assert (col >= 0 && row >= 0);
+    assert (col + (long)(width - 1) * col_step < parent->width);
+    assert (row + (long)(height - 1) * row_step < parent->height);
+
+    T view = malloc(sizeof(struct T));
+    assert (view != NULL);
+
+    *view = *parent;
+    view->elems = element_at(parent, col, row);
+    view->elems_size = 0;
+    view->width = width;
+    view->height = height;
+    view->col_stride = parent->col_stride * col_step;
+    view->row_stride = parent->row_stride * row_step;
+    view->pooled = 0;
+    view->is_view = 1;
+    view->map = NULL;
+
+    return view;
+}
+
 /* UArray2_width
  * Purpose: Returns the width of a given UArray2
  * Parameters: the UArray2
@@ -124,6 +289,230 @@ int UArray2_size(T uarray2){
     return uarray2->size;
 }
 
+/* UArray2_storage
+ * Purpose: Returns the order in which a UArray2's elements are stored
+ * Parameters: the UArray2
+ * Returns: the UArray2_order given when the UArray2 was created
+ * Expected input: a valid UArray2
+ * Success output: the storage order
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+UArray2_order UArray2_storage(T uarray2)
+{
+    assert (uarray2 != NULL);
+
+    return uarray2->order;
+}
+
+/* UArray2_blocksize
+ * Purpose: Returns the side of the square blocks of a UArray2
+ * Parameters: the UArray2
+ * Returns: the number of elements along one side of a block
+ * Expected input: a valid UArray2
+ * Success output: the block side, or 1 if the storage is not blocked
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+int UArray2_blocksize(T uarray2)
+{
+    assert (uarray2 != NULL);
+
+    if (uarray2->order != UArray2_BLOCKED) {
+        return 1;
+    }
+
+    return 1 << uarray2->block_shift;
+}
+
+/* UArray2_row
+ * Purpose: Returns a pointer to the first element of a row, with the
+ *          distance between its elements and its length
+ * Parameters: the UArray2, the row, and pointers to a size_t for the
+ *             stride in bytes and an int for the number of elements
+ * Returns: a void pointer to element (0, row)
+ * Expected input: a valid UArray2 that is not blocked and a row within
+ *                 its bounds; either out pointer may be null
+ * Success output: element (col, row) is at the pointer plus col * stride
+ * Failure output: if the UArray2 is null or blocked, or if the row is out
+ *                 of bounds, a Hanson CRE is raised
+ */
+void *UArray2_row(T uarray2, int row, size_t *stride, int *length)
+{
+    assert (uarray2 != NULL && uarray2->order != UArray2_BLOCKED);
+    assert (row >= 0 && row < uarray2->height);
+
+    if (stride != NULL) {
+        *stride = uarray2->col_stride;
+    }
+    if (length != NULL) {
+        *length = uarray2->width;
+    }
+
+    return uarray2->elems + row * uarray2->row_stride;
+}
+
+/* UArray2_col
+ * Purpose: Returns a pointer to the first element of a column, with the
+ *          distance between its elements and its length
+ * Parameters: the UArray2, the column, and pointers to a size_t for the
+ *             stride in bytes and an int for the number of elements
+ * Returns: a void pointer to element (col, 0)
+ * Expected input: a valid UArray2 that is not blocked and a column within
+ *                 its bounds; either out pointer may be null
+ * Success output: element (col, row) is at the pointer plus row * stride
+ * Failure output: if the UArray2 is null or blocked, or if the column is
+ *                 out of bounds, a Hanson CRE is raised
+ */
+void *UArray2_col(T uarray2, int col, size_t *stride, int *length)
+{
+    assert (uarray2 != NULL && uarray2->order != UArray2_BLOCKED);
+    assert (col >= 0 && col < uarray2->width);
+
+    if (stride != NULL) {
+        *stride = uarray2->row_stride;
+    }
+    if (length != NULL) {
+        *length = uarray2->height;
+    }
+
+    return uarray2->elems + col * uarray2->col_stride;
+}
+
+/* UArray2_copy_row
+ * Purpose: Copies every element of one row into a row of another (or the
+ *          same) UArray2
+ * Parameters: the destination UArray2 and row, and the source UArray2
+ *             and row
+ * Returns: none
+ * Expected input: two valid UArray2s of the same width and element size
+ *                 and rows within their bounds
+ * Success output: the destination row holds a copy of the source row
+ * Failure output: if either UArray2 is null, the widths or sizes differ,
+ *                 or a row is out of bounds, a Hanson CRE is raised
+ */
+void UArray2_copy_row(T dst, int dst_row, T src, int src_row)
+{
+    assert (dst != NULL && src != NULL);
+    assert (dst->width == src->width && dst->size == src->size);
+    assert (dst_row >= 0 && dst_row < dst->height);
+    assert (src_row >= 0 && src_row < src->height);
+
+    if (dst == src && dst_row == src_row) {
+        return;
+    }
+
+    /* Contiguous rows: row-major arrays and views of them with a column
+     * step of 1 */
+    if (dst->order != UArray2_BLOCKED && dst->col_stride == dst->size
+        && src->order != UArray2_BLOCKED && src->col_stride == src->size) {
+        memcpy(dst->elems + dst_row * dst->row_stride,
+               src->elems + src_row * src->row_stride,
+               dst->width * dst->size);
+        return;
+    }
+
+    for (int col = 0; col < dst->width; col++) {
+        memcpy(element_at(dst, col, dst_row), element_at(src, col, src_row),
+               dst->size);
+    }
+}
+
+/* UArray2_fill_row
+ * Purpose: Sets every element of a row to a copy of one value
+ * Parameters: the UArray2, the row, and a pointer to the value
+ * Returns: none
+ * Expected input: a valid UArray2, a row within its bounds, and a
+ *                 pointer to UArray2_size bytes
+ * Success output: every element of the row equals the value
+ * Failure output: if the UArray2 or value is null, or if the row is out
+ *                 of bounds, a Hanson CRE is raised
+ *
+ *       Note: Row-major rows are filled by doubling memcpys (or one
+ *             memset for 1-byte elements).
+ */
+void UArray2_fill_row(T uarray2, int row, const void *elem)
+{
+    assert (uarray2 != NULL && elem != NULL);
+    assert (row >= 0 && row < uarray2->height);
+
+    size_t size = uarray2->size;
+
+    if (uarray2->order == UArray2_BLOCKED || uarray2->col_stride != size) {
+        for (int col = 0; col < uarray2->width; col++) {
+            memmove(element_at(uarray2, col, row), elem, size);
+        }
+        return;
+    }
+
+    char *first = uarray2->elems + row * uarray2->row_stride;
+    size_t total = uarray2->width * size;
+
+    if (size == 1) {
+        memset(first, *(const unsigned char *)elem, total);
+        return;
+    }
+
+    memmove(first, elem, size);
+    for (size_t done = size; done < total; ) {
+        size_t chunk = done < total - done ? done : total - done;
+        memcpy(first + done, first, chunk);
+        done += chunk;
+    }
+}
+
+/* UArray2_transpose
+ * Purpose: Copies the transpose of one UArray2 into another
+ * Parameters: the destination UArray2 and the source UArray2
+ * Returns: none
+ * Expected input: two distinct, non-overlapping UArray2s with the same
+ *                 element size, where the destination's width is the
+ *                 source's height and its height is the source's width;
+ *                 any storage orders
+ * Success output: element (row, col) of the destination is a copy of
+ *                 element (col, row) of the source
+ * Failure output: if either UArray2 is null, they are the same array, or
+ *                 the sizes do not match, a Hanson CRE is raised
+ *           Note: The arrays are split in half recursively, along the
+ *                 longer side, until both tiles fit in cache, so the
+ *                 copy is cache-oblivious.
+ */
+void UArray2_transpose(T dst, T src)
+{
+    assert (dst != NULL && src != NULL && dst != src);
+    assert (dst->width == src->height && dst->height == src->width);
+    assert (dst->size == src->size);
+
+    transpose_range(dst, src, 0, 0, src->width, src->height);
+}
+
+/* UArray2_transpose_square
+ * Purpose: Transposes a square UArray2 in place
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a valid UArray2 whose width equals its height; any
+ *                 storage order
+ * Success output: elements (col, row) and (row, col) have been swapped
+ *                 for every col and row
+ * Failure output: if the UArray2 is null or not square, a Hanson CRE is
+ *                 raised
+ */
+void UArray2_transpose_square(T uarray2)
+{
+    assert (uarray2 != NULL && uarray2->width == uarray2->height);
+
+    int side = uarray2->width;
+
+    /* Each tile above the diagonal is swapped with its mirror below */
+    for (int col = 0; col < side; col += TRANSPOSE_SIDE) {
+        for (int row = col; row < side; row += TRANSPOSE_SIDE) {
+            int cols = side - col < TRANSPOSE_SIDE ? side - col
+                                                   : TRANSPOSE_SIDE;
+            int rows = side - row < TRANSPOSE_SIDE ? side - row
+                                                   : TRANSPOSE_SIDE;
+            swap_tile(uarray2, col, row, cols, rows);
+        }
+    }
+}
+
 /* UArray2_map_col_major
  * Purpose: Traverse a given UArray2 column by column starting from 
  *             the top left element, calling the apply function on each
@@ -147,13 +536,21 @@ void UArray2_map_col_major(T uarray2, void apply(int col, int row, T a,
                                         void *p1, void *p2), void *cl){
     assert (uarray2 != NULL && apply != NULL);
 
+    if (uarray2->order == UArray2_BLOCKED) {
+        for (int col = 0; col < uarray2->width; col++) {
+            for (int row = 0; row < uarray2->height; row++) {
+                apply(col, row, uarray2, element_at(uarray2, col, row), cl);
+            }
+        }
+        return;
+    }
+
     for (int col = 0; col < uarray2->width; col++) {
-        UArray_T *curr_column = UArray_at(uarray2->col_uarray, col);
+        char *curr_element = uarray2->elems + col * uarray2->col_stride;
 
         for(int row = 0; row < uarray2->height; row++) {
-            void *curr_element = UArray_at(*curr_column, row);
-
             apply(col, row, uarray2, curr_element, cl);
+            curr_element += uarray2->row_stride;
         }
     }
 }
@@ -181,17 +578,554 @@ void UArray2_map_row_major(T uarray2, void apply(int col, int row, T a,
                                         void *p1, void *p2), void *cl){
     assert (uarray2 != NULL && apply != NULL);
 
+    if (uarray2->order == UArray2_BLOCKED) {
+        for (int row = 0; row < uarray2->height; row++) {
+            for (int col = 0; col < uarray2->width; col++) {
+                apply(col, row, uarray2, element_at(uarray2, col, row), cl);
+            }
+        }
+        return;
+    }
+
     for (int row = 0; row < uarray2->height; row++) {
-        for (int col = 0; col < uarray2->width; col++) {
-            UArray_T curr_column = *(UArray_T *)UArray_at(uarray2->col_uarray,
-                                                                         col);
-            void *curr_element = UArray_at(curr_column, row);
+        char *curr_element = uarray2->elems + row * uarray2->row_stride;
 
+        for (int col = 0; col < uarray2->width; col++) {
             apply(col, row, uarray2, curr_element, cl);
+            curr_element += uarray2->col_stride;
         }  
     }
 }
 
+/* UArray2_map_default
+ * Purpose: Traverse a given UArray2 in the order its elements are stored,
+ *             calling the apply function on each element
+ * Parameters: the UArray2, function pointer to the function to apply to
+ *             each element, and void pointer to the closure value
+ * Returns: none
+ * Expected input: a valid UArray2, a matching apply function, and either
+ *                 a closure pointer or a null closure parameter
+ * Success output: none
+ * Failure output: if either the UArray2 or the apply function are null, a
+ *                 Hanson CRE is raised
+ */
+void UArray2_map_default(T uarray2, void apply(int col, int row, T a,
+                                        void *p1, void *p2), void *cl)
+{
+    assert (uarray2 != NULL && apply != NULL);
+
+    map_range(uarray2, 0, outer_count(uarray2), apply, cl);
+}
+
+/* UArray2_map_block_major
+ * Purpose: Traverse a given UArray2 one square tile at a time, calling
+ *             the apply function on each element
+ * Parameters: the UArray2, the tile side in elements (0 for the
+ *             default), the apply function, and the closure value
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative tile side, a matching
+ *                 apply function, and a closure pointer or null
+ * Success output: none
+ * Failure output: if the UArray2 or apply function are null, or if the
+ *                 tile side is negative, a Hanson CRE is raised
+ */
+void UArray2_map_block_major(T uarray2, int tile,
+                             void apply(int col, int row, T a,
+                                        void *p1, void *p2), void *cl)
+{
+    assert (uarray2 != NULL && apply != NULL);
+    assert (tile >= 0);
+
+    if (tile == 0) {
+        tile = UArray2_default_tile(uarray2);
+    }
+
+    int width = uarray2->width;
+    int height = uarray2->height;
+
+    if (uarray2->order == UArray2_COL_MAJOR) {
+        /* Tiles in column-major order, each walked column by column */
+        for (int col0 = 0; col0 < width; col0 += tile) {
+            int col_end = col0 + tile < width ? col0 + tile : width;
+
+            for (int row0 = 0; row0 < height; row0 += tile) {
+                int row_end = row0 + tile < height ? row0 + tile : height;
+
+                for (int col = col0; col < col_end; col++) {
+                    char *curr_element = uarray2->elems
+                                         + col * uarray2->col_stride
+                                         + row0 * uarray2->row_stride;
+
+                    for (int row = row0; row < row_end; row++) {
+                        apply(col, row, uarray2, curr_element, cl);
+                        curr_element += uarray2->row_stride;
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    /* Tiles in row-major order, each walked row by row */
+    for (int row0 = 0; row0 < height; row0 += tile) {
+        int row_end = row0 + tile < height ? row0 + tile : height;
+
+        for (int col0 = 0; col0 < width; col0 += tile) {
+            int col_end = col0 + tile < width ? col0 + tile : width;
+
+            for (int row = row0; row < row_end; row++) {
+                if (uarray2->order == UArray2_BLOCKED) {
+                    for (int col = col0; col < col_end; col++) {
+                        apply(col, row, uarray2,
+                              element_at(uarray2, col, row), cl);
+                    }
+                    continue;
+                }
+
+                char *curr_element = uarray2->elems
+                                     + row * uarray2->row_stride
+                                     + col0 * uarray2->col_stride;
+
+                for (int col = col0; col < col_end; col++) {
+                    apply(col, row, uarray2, curr_element, cl);
+                    curr_element += uarray2->col_stride;
+                }
+            }
+        }
+    }
+}
+
+/* UArray2_default_tile
+ * Purpose: Returns the tile side UArray2_map_block_major uses by default
+ * Parameters: the UArray2
+ * Returns: the tile side in elements
+ * Expected input: a valid UArray2
+ * Success output: the block side for blocked storage, and otherwise the
+ *                 largest power of two whose square tile fits in
+ *                 TILE_BYTES (at least 1)
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+int UArray2_default_tile(T uarray2)
+{
+    assert (uarray2 != NULL);
+
+    if (uarray2->order == UArray2_BLOCKED) {
+        return 1 << uarray2->block_shift;
+    }
+
+    int tile = 1;
+    while ((size_t)(2 * tile) * (2 * tile) * uarray2->size <= TILE_BYTES) {
+        tile *= 2;
+    }
+
+    return tile;
+}
+
+/* UArray2_map_parallel
+ * Purpose: Traverse a given UArray2 with a pool of worker threads that
+ *             claim chunks of whole columns, rows or block rows in
+ *             storage order as they free up, calling the apply function
+ *             on each element with the worker's own copy of the closure
+ *             value, then folding the per-worker closures back into the
+ *             caller's closure
+ * Parameters: the UArray2, the number of worker threads (0 uses one per
+ *             online processor), the thread-safe apply function, the
+ *             closure value and its size in bytes, and the reduce function
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative thread count, a
+ *                 matching apply function, and a closure of cl_size bytes
+ * Success output: none
+ * Failure output: if either the UArray2 or the apply function are null,
+ *                 or if the thread count is negative, a Hanson CRE is
+ *                 raised
+ */
+void UArray2_map_parallel(T uarray2, int num_threads,
+                          void apply(int col, int row, T a,
+                                     void *p1, void *p2),
+                          void *cl, size_t cl_size,
+                          void reduce(void *cl, void *thread_cl))
+{
+    assert (uarray2 != NULL && apply != NULL);
+    assert (num_threads >= 0);
+    assert (cl_size == 0 || cl != NULL);
+
+    int units_per_chunk = chunk_units(uarray2);
+    int units = outer_count(uarray2);
+    int num_chunks = (units + units_per_chunk - 1) / units_per_chunk;
+
+    /* Parallel_chunks runs no more workers than there are chunks */
+    if (num_threads == 0) {
+        num_threads = Parallel_default_threads();
+    }
+    if (num_threads > num_chunks) {
+        num_threads = num_chunks;
+    }
+
+    MapParallelData data = { uarray2, apply, cl, cl_size, NULL,
+                             units_per_chunk };
+
+    if (cl_size > 0) {
+        data.thread_cls = malloc(num_threads * cl_size);
+        assert (data.thread_cls != NULL);
+
+        for (int i = 0; i < num_threads; i++) {
+            memcpy(data.thread_cls + i * cl_size, cl, cl_size);
+        }
+    }
+
+    Parallel_chunks(num_threads, num_chunks, map_parallel_chunk, &data);
+
+    if (cl_size > 0) {
+        for (int i = 0; reduce != NULL && i < num_threads; i++) {
+            reduce(cl, data.thread_cls + i * cl_size);
+        }
+        free(data.thread_cls);
+    }
+}
+
+/* UArray2_reduce_parallel
+ * Purpose: Folds every element of a UArray2 into a result on a pool of
+ *          worker threads, with the same result for any thread count
+ * Parameters: the UArray2, the number of worker threads (0 uses one per
+ *             online processor), the apply function, a pointer to the
+ *             identity value, a pointer to the result and its size in
+ *             bytes, and the combine function
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative thread count, and
+ *                 non-null function and value pointers
+ * Success output: the partial results have been combined into *result
+ * Failure output: if any pointer is null, the size is 0, or the thread
+ *                 count is negative, a Hanson CRE is raised
+ *
+ *       Note: Chunks depend only on the array's shape, each has its own
+ *             partial, and partials are combined in chunk order.
+ */
+void UArray2_reduce_parallel(T uarray2, int num_threads,
+                             void apply(int col, int row, T a,
+                                        void *p1, void *p2),
+                             const void *identity, void *result,
+                             size_t result_size,
+                             void combine(void *result, void *partial))
+{
+    assert (uarray2 != NULL && apply != NULL && combine != NULL);
+    assert (identity != NULL && result != NULL && result_size > 0);
+    assert (num_threads >= 0);
+
+    int units_per_chunk = chunk_units(uarray2);
+    int units = outer_count(uarray2);
+    int num_chunks = (units + units_per_chunk - 1) / units_per_chunk;
+
+    ReduceData data = { uarray2, apply, units_per_chunk, result_size,
+                        NULL };
+
+    data.partials = malloc(num_chunks * result_size);
+    assert (data.partials != NULL);
+
+    for (int i = 0; i < num_chunks; i++) {
+        memcpy(data.partials + i * result_size, identity, result_size);
+    }
+
+    Parallel_chunks(num_threads, num_chunks, reduce_chunk, &data);
+
+    for (int i = 0; i < num_chunks; i++) {
+        combine(result, data.partials + i * result_size);
+    }
+
+    free(data.partials);
+}
+
+/* UArray2_save
+ * Purpose: Writes a UArray2 to a file in the binary arrayfile format
+ * Parameters: the UArray2 and a file pointer for the output stream
+ * Returns: none
+ * Expected input: a valid UArray2 and a stream open for binary writing
+ * Success output: the header and the elements, in storage order, are
+ *                 written; a view is written as if it were a copy
+ * Failure output: if the UArray2 or file pointer is null, or if the
+ *                 write fails, a Hanson CRE is raised
+ */
+void UArray2_save(T uarray2, FILE *fp)
+{
+    assert (uarray2 != NULL && fp != NULL);
+
+    ArrayFile_header header;
+    fill_header(uarray2, &header);
+
+    ArrayFile_sum sum;
+    ArrayFile_sum_init(&sum);
+
+    /* A view is gathered line by line, once for the checksum and once
+     * for the payload, so the file matches a saved copy of the view */
+    if (!uarray2->is_view) {
+        ArrayFile_sum_add(&sum, uarray2->elems, uarray2->elems_size);
+        header.checksum = ArrayFile_sum_final(&sum);
+        ArrayFile_write_header(&header, fp);
+
+        size_t written = fwrite(uarray2->elems, 1, uarray2->elems_size,
+                                fp);
+        assert (written == uarray2->elems_size);
+        return;
+    }
+
+    int num_lines = outer_count(uarray2);
+    char *line = calloc(1, header.stride);
+    assert (line != NULL);
+
+    for (int i = 0; i < num_lines; i++) {
+        gather_line(uarray2, i, line);
+        ArrayFile_sum_add(&sum, line, header.stride);
+    }
+    header.checksum = ArrayFile_sum_final(&sum);
+    ArrayFile_write_header(&header, fp);
+
+    for (int i = 0; i < num_lines; i++) {
+        gather_line(uarray2, i, line);
+        size_t written = fwrite(line, 1, header.stride, fp);
+        assert (written == header.stride);
+    }
+
+    free(line);
+}
+
+/* UArray2_load
+ * Purpose: Reads a UArray2 written by UArray2_save
+ * Parameters: a file pointer for the input stream
+ * Returns: the new UArray2
+ * Expected input: a stream positioned at the start of a saved UArray2
+ * Success output: a UArray2 with the saved dimensions, size and elements
+ * Failure output: if the file pointer is null, if the read fails, or if
+ *                 the header or checksum is invalid, a Hanson CRE is
+ *                 raised
+ */
+T UArray2_load(FILE *fp)
+{
+    assert (fp != NULL);
+
+    ArrayFile_header header;
+    ArrayFile_read_header(&header, ArrayFile_UARRAY2, fp);
+
+    assert (header.width <= INT_MAX && header.height <= INT_MAX);
+    assert (header.elem_size > 0 && header.elem_size <= INT_MAX);
+
+    int block_shift;
+    UArray2_order order = header_order(&header, &block_shift);
+
+    T uarray2 = new_array(header.width, header.height, header.elem_size,
+                          order, block_shift, NULL);
+    size_t line_bytes = uarray2->block_bytes;
+    size_t used_bytes = line_bytes;
+
+    if (order == UArray2_COL_MAJOR) {
+        line_bytes = uarray2->col_stride;
+        used_bytes = uarray2->height * uarray2->size;
+    } else if (order == UArray2_ROW_MAJOR) {
+        line_bytes = uarray2->row_stride;
+        used_bytes = uarray2->width * uarray2->size;
+    }
+
+    size_t num_lines = uarray2->elems_size / line_bytes;
+    ArrayFile_sum sum;
+    ArrayFile_sum_init(&sum);
+
+    if (header.stride == line_bytes) {
+        assert (header.payload_size == uarray2->elems_size);
+
+        size_t read = fread(uarray2->elems, 1, uarray2->elems_size, fp);
+        assert (read == uarray2->elems_size);
+        ArrayFile_sum_add(&sum, uarray2->elems, uarray2->elems_size);
+    } else {
+        /* Lines saved with other padding are copied over one by one */
+        assert (order != UArray2_BLOCKED);
+        assert (header.stride >= used_bytes);
+        assert (header.payload_size / header.stride == num_lines
+                && header.payload_size % header.stride == 0);
+
+        char *line = malloc(header.stride);
+        assert (line != NULL);
+
+        for (size_t i = 0; i < num_lines; i++) {
+            size_t read = fread(line, 1, header.stride, fp);
+            assert (read == header.stride);
+            ArrayFile_sum_add(&sum, line, header.stride);
+            memcpy(uarray2->elems + i * line_bytes, line, used_bytes);
+        }
+
+        free(line);
+    }
+
+    /* An unsealed file was synced from a mapping without a checksum */
+    assert ((header.flags & ARRAYFILE_UNSEALED)
+            || ArrayFile_sum_final(&sum) == header.checksum);
+
+    return uarray2;
+}
+
+/* UArray2_new_file
+ * Purpose: Creates a new UArray2 whose elements live in a memory-mapped
+ *          file
+ * Parameters: the path of the file, the width, height and element size,
+ *             and the UArray2_order
+ * Returns: the new UArray2
+ * Expected input: a writable path and the same sizes as UArray2_new_order
+ * Success output: the file is created (or truncated) and holds an
+ *                 arrayfile header followed by zero-filled elements
+ * Failure output: if the file cannot be created, sized or mapped, or if
+ *                 the sizes are invalid, a Hanson CRE is raised
+ */
+T UArray2_new_file(const char *path, int width, int height, size_t size,
+                   UArray2_order order)
+{
+    assert (path != NULL && size > 0);
+
+    struct T shape;
+    set_shape(&shape, width, height, size, order, default_block_shift(size));
+
+    /* The checksum is left at 0 and the file unsealed until the first
+     * UArray2_seal */
+    ArrayFile_header header;
+    fill_header(&shape, &header);
+    header.checksum = 0;
+
+    FILE *fp = fopen(path, "w+b");
+    assert (fp != NULL);
+    ArrayFile_write_header(&header, fp);
+    int status = fflush(fp);
+    assert (status == 0);
+
+    /* Growing the file leaves a hole that reads as zeros, so nothing is
+     * written or paged in until it is used */
+    status = ftruncate(fileno(fp), sizeof(header) + shape.elems_size);
+    assert (status == 0);
+
+    T uarray2 = map_file(fileno(fp), &header, 1);
+    ((ArrayFile_header *)uarray2->map)->flags |= ARRAYFILE_UNSEALED;
+    fclose(fp);
+
+    return uarray2;
+}
+
+/* UArray2_open_file
+ * Purpose: Maps a UArray2 saved by UArray2_save or UArray2_new_file
+ *          back into memory in place
+ * Parameters: the path of the file and an int that is nonzero if the
+ *             elements may be changed
+ * Returns: the new UArray2
+ * Expected input: a file holding a saved UArray2 with the padding this
+ *                 build uses
+ * Success output: a UArray2 whose elements are the file's payload
+ * Failure output: if the file cannot be opened or mapped, or if the
+ *                 header is invalid, a Hanson CRE is raised
+ */
+T UArray2_open_file(const char *path, int writable)
+{
+    assert (path != NULL);
+
+    FILE *fp = fopen(path, writable ? "r+b" : "rb");
+    assert (fp != NULL);
+
+    ArrayFile_header header;
+    ArrayFile_read_header(&header, ArrayFile_UARRAY2, fp);
+
+    T uarray2 = map_file(fileno(fp), &header, writable);
+    fclose(fp);
+
+    /* Any element may change from here on, so the checksum is stale
+     * until UArray2_seal; only the header page is touched */
+    if (writable) {
+        ((ArrayFile_header *)uarray2->map)->flags |= ARRAYFILE_UNSEALED;
+    }
+
+    return uarray2;
+}
+
+/* UArray2_advise
+ * Purpose: Tells the kernel how the elements of a file-backed UArray2
+ *          will be used
+ * Parameters: the UArray2 and a UArray2_advice
+ * Returns: none
+ * Expected input: a UArray2 from UArray2_new_file or UArray2_open_file
+ * Success output: the advice is passed on with posix_madvise
+ * Failure output: if the UArray2 is null or not file-backed, or the
+ *                 advice is invalid, a Hanson CRE is raised
+ */
+void UArray2_advise(T uarray2, UArray2_advice advice)
+{
+    assert (uarray2 != NULL && uarray2->map != NULL);
+
+    int kernel_advice = POSIX_MADV_NORMAL;
+    switch (advice) {
+    case UArray2_ADVISE_NORMAL:
+        break;
+    case UArray2_ADVISE_SEQUENTIAL:
+        kernel_advice = POSIX_MADV_SEQUENTIAL;
+        break;
+    case UArray2_ADVISE_RANDOM:
+        kernel_advice = POSIX_MADV_RANDOM;
+        break;
+    case UArray2_ADVISE_WILLNEED:
+        kernel_advice = POSIX_MADV_WILLNEED;
+        break;
+    case UArray2_ADVISE_DONTNEED:
+        kernel_advice = POSIX_MADV_DONTNEED;
+        break;
+    default:
+        assert (0);
+    }
+
+    int status = posix_madvise(uarray2->map, uarray2->map_bytes,
+                               kernel_advice);
+    assert (status == 0);
+}
+
+/* UArray2_sync
+ * Purpose: Writes the elements of a file-backed UArray2 to its file
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a UArray2 from UArray2_new_file or UArray2_open_file
+ * Success output: every changed page is written with msync before
+ *                 returning; pages never touched are not read
+ * Failure output: if the UArray2 is null or not file-backed, or msync
+ *                 fails, a Hanson CRE is raised
+ */
+void UArray2_sync(T uarray2)
+{
+    assert (uarray2 != NULL && uarray2->map != NULL);
+
+    if (!uarray2->map_writable) {
+        return;
+    }
+
+    int status = msync(uarray2->map, uarray2->map_bytes, MS_SYNC);
+    assert (status == 0);
+}
+
+/* UArray2_seal
+ * Purpose: Brings the checksum of a file-backed UArray2 up to date and
+ *          writes the array to its file
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a writable UArray2 from UArray2_new_file or
+ *                 UArray2_open_file
+ * Success output: the header holds the payload's checksum, the file is
+ *                 no longer marked unsealed, and it has been synced
+ * Failure output: if the UArray2 is null, not file-backed or read-only,
+ *                 or msync fails, a Hanson CRE is raised
+ */
+void UArray2_seal(T uarray2)
+{
+    assert (uarray2 != NULL && uarray2->map != NULL);
+    assert (uarray2->map_writable);
+
+    ArrayFile_header *header = (ArrayFile_header *)uarray2->map;
+    ArrayFile_sum sum;
+    ArrayFile_sum_init(&sum);
+    ArrayFile_sum_add(&sum, uarray2->elems, uarray2->elems_size);
+    header->checksum = ArrayFile_sum_final(&sum);
+    header->flags &= ~ARRAYFILE_UNSEALED;
+
+    UArray2_sync(uarray2);
+}
+
 /* UArray2_free
  * Purpose: Frees memory associated with a given UArray2, including the
  *          elements stored inside of it.
@@ -205,12 +1139,590 @@ void UArray2_map_row_major(T uarray2, void apply(int col, int row, T a,
 void UArray2_free(T *uarray2){
     assert (*uarray2 != NULL && uarray2 != NULL);
 
-    for (int col = 0; col < (*uarray2)->width; col++) {
-        UArray_T *curr_column_p = UArray_at((*uarray2)->col_uarray, col);
-        UArray_T curr_column = *curr_column_p;
-        UArray_free(&curr_column);
+    /* Only changed pages are written; the checksum is left to
+     * UArray2_seal */
+    if ((*uarray2)->map != NULL) {
+        UArray2_sync(*uarray2);
+        munmap((*uarray2)->map, (*uarray2)->map_bytes);
+    }
+
+    if (!(*uarray2)->pooled) {
+        free(*uarray2);
     }
-    
-    UArray_free(&(*uarray2)->col_uarray);
-    free(*uarray2);
 }
+
+/* chunk_units
+ *    Purpose: Works out how many whole columns, rows or block rows make
+ *             up one chunk of parallel work, about CHUNK_ELEMS elements
+ * Parameters: the UArray2
+ *    Returns: the number of outer units per chunk, at least 1
+ *
+ *       Note: Depends only on the array's shape, never on the thread
+ *             count.
+ */
+static int chunk_units(T uarray2)
+{
+    size_t unit_elems = uarray2->order == UArray2_COL_MAJOR
+                        ? (size_t)uarray2->height
+                        : uarray2->order == UArray2_ROW_MAJOR
+                        ? (size_t)uarray2->width
+                        : (size_t)uarray2->blocks_wide
+                          << (2 * uarray2->block_shift);
+
+    return unit_elems >= CHUNK_ELEMS ? 1 : (int)(CHUNK_ELEMS / unit_elems);
+}
+
+/* map_parallel_chunk
+ *    Purpose: Work body for UArray2_map_parallel; applies the caller's
+ *             function to every element of one chunk of outer units
+ * Parameters: the worker index, the chunk index, and a void pointer to
+ *             the shared MapParallelData
+ *    Returns: void
+ */
+static void map_parallel_chunk(int worker, int chunk, void *cl)
+{
+    MapParallelData *data = cl;
+    int units = outer_count(data->uarray2);
+    int lo = chunk * data->units_per_chunk;
+    int hi = lo + data->units_per_chunk < units ? lo + data->units_per_chunk
+                                                : units;
+    void *worker_cl = data->cl;
+
+    if (data->cl_size > 0) {
+        worker_cl = data->thread_cls + worker * data->cl_size;
+    }
+
+    map_range(data->uarray2, lo, hi, data->apply, worker_cl);
+}
+
+/* reduce_chunk
+ *    Purpose: Work body for UArray2_reduce_parallel; folds one chunk of
+ *             outer units into that chunk's partial result
+ * Parameters: the worker index, the chunk index, and a void pointer to
+ *             the shared ReduceData
+ *    Returns: void
+ */
+static void reduce_chunk(int worker, int chunk, void *cl)
+{
+    ReduceData *data = cl;
+    int units = outer_count(data->uarray2);
+    int lo = chunk * data->units_per_chunk;
+    int hi = lo + data->units_per_chunk < units ? lo + data->units_per_chunk
+                                                : units;
+    (void)worker;
+
+    map_range(data->uarray2, lo, hi, data->apply,
+              data->partials + chunk * data->result_size);
+}
+
+/* new_array
+ *    Purpose: Allocates a UArray2 and its elements in one block and sets
+ *             up the strides of the chosen storage order
+ * Parameters: the width, height, element size, storage order, the log2
+ *             of the block side (used only for blocked storage), and the
+ *             Pool to allocate from, or NULL for the heap
+ *    Returns: the new UArray2, with every element zeroed
+ */
+static T new_array(int width, int height, size_t size,
+                   UArray2_order order, int block_shift, Pool_T pool)
+{
+    struct T shape;
+    set_shape(&shape, width, height, size, order, block_shift);
+
+    size_t total = sizeof(struct T) + UARRAY2_ALIGN + shape.elems_size;
+    T new_uarray2;
+
+    /* Elements start zero-filled, as with Hanson's UArray_new */
+    if (pool != NULL) {
+        new_uarray2 = Pool_alloc(pool, total, sizeof(void *));
+        memset(new_uarray2, 0, total);
+    } else {
+        new_uarray2 = calloc(1, total);
+        assert (new_uarray2 != NULL);
+    }
+
+    uintptr_t first = (uintptr_t)(new_uarray2 + 1);
+    first = (first + UARRAY2_ALIGN - 1) & ~(uintptr_t)(UARRAY2_ALIGN - 1);
+
+    *new_uarray2 = shape;
+    new_uarray2->elems = (char *)first;
+    new_uarray2->pooled = pool != NULL;
+
+    return new_uarray2;
+}
+
+/* set_shape
+ *    Purpose: Fills in the dimensions and strides of a UArray2 for a
+ *             storage order, without any elements
+ * Parameters: the UArray2 to fill in, the width, height, element size,
+ *             storage order, and the log2 of the block side (used only
+ *             for blocked storage)
+ *    Returns: void; elems_size is set to the bytes the elements need
+ */
+static void set_shape(T uarray2, int width, int height, size_t size,
+                      UArray2_order order, int block_shift)
+{
+    assert (width > 0 && height > 0);
+    assert (size > 0);
+    assert (order == UArray2_COL_MAJOR || order == UArray2_ROW_MAJOR
+            || order == UArray2_BLOCKED);
+    assert (block_shift >= 0 && block_shift < 15);
+
+    /* Storage is a run of equal lines: columns, rows, or blocks */
+    size_t line_elems, num_lines;
+    size_t side = (size_t)1 << block_shift;
+    size_t blocks_wide = ((size_t)width + side - 1) >> block_shift;
+    size_t blocks_high = ((size_t)height + side - 1) >> block_shift;
+
+    if (order == UArray2_COL_MAJOR) {
+        line_elems = height;
+        num_lines = width;
+    } else if (order == UArray2_ROW_MAJOR) {
+        line_elems = width;
+        num_lines = height;
+    } else {
+        line_elems = side * side;
+        num_lines = blocks_wide * blocks_high;
+    }
+
+    assert (line_elems <= (SIZE_MAX - UARRAY2_ALIGN) / size);
+    size_t line_bytes = line_elems * size;
+
+    /* Columns and rows start on UARRAY2_ALIGN boundaries */
+    if (order != UArray2_BLOCKED) {
+        line_bytes = padded_line(line_bytes);
+    }
+
+    assert (num_lines <= (SIZE_MAX - sizeof(struct T) - UARRAY2_ALIGN)
+                         / line_bytes);
+
+    memset(uarray2, 0, sizeof(*uarray2));
+    uarray2->elems_size = num_lines * line_bytes;
+    uarray2->width = width;
+    uarray2->height = height;
+    uarray2->size = size;
+    uarray2->order = order;
+
+    if (order == UArray2_COL_MAJOR) {
+        uarray2->col_stride = line_bytes;
+        uarray2->row_stride = size;
+    } else if (order == UArray2_ROW_MAJOR) {
+        uarray2->col_stride = size;
+        uarray2->row_stride = line_bytes;
+    } else {
+        uarray2->block_shift = block_shift;
+        uarray2->blocks_wide = blocks_wide;
+        uarray2->blocks_high = blocks_high;
+        uarray2->block_bytes = line_bytes;
+    }
+}
+
+/* default_block_shift
+ *    Purpose: Picks the block side of blocked storage
+ * Parameters: the element size
+ *    Returns: the log2 of the largest power-of-two side whose block fits
+ *             in BLOCK_BYTES
+ */
+static int default_block_shift(size_t size)
+{
+    int block_shift = 0;
+    while (((size_t)4 << (2 * block_shift)) * size <= BLOCK_BYTES) {
+        block_shift++;
+    }
+
+    return block_shift;
+}
+
+/* element_at
+ *    Purpose: Locates an element without checking its bounds
+ * Parameters: the UArray2 and the element's column and row
+ *    Returns: a pointer to the element
+ */
+static inline char *element_at(T uarray2, int col, int row)
+{
+    if (uarray2->order != UArray2_BLOCKED) {
+        return uarray2->elems + col * uarray2->col_stride
+                              + row * uarray2->row_stride;
+    }
+
+    int shift = uarray2->block_shift;
+    int mask = (1 << shift) - 1;
+    size_t block = (size_t)(row >> shift) * uarray2->blocks_wide
+                   + (col >> shift);
+    size_t offset = ((size_t)(row & mask) << shift) + (col & mask);
+
+    return uarray2->elems + block * uarray2->block_bytes
+                          + offset * uarray2->size;
+}
+
+/* outer_count
+ *    Purpose: Counts the outermost units of a UArray2's storage order
+ * Parameters: the UArray2
+ *    Returns: the number of columns, rows or block rows
+ */
+static int outer_count(T uarray2)
+{
+    if (uarray2->order == UArray2_COL_MAJOR) {
+        return uarray2->width;
+    } else if (uarray2->order == UArray2_ROW_MAJOR) {
+        return uarray2->height;
+    }
+
+    return uarray2->blocks_high;
+}
+
+/* map_range
+ *    Purpose: Applies a function to the elements of outer units lo to
+ *             hi - 1 (columns, rows or block rows), in storage order, so
+ *             memory is read sequentially
+ * Parameters: the UArray2, the range of outer units, the apply function
+ *             and its closure
+ *    Returns: void
+ *
+ *       Note: Padding elements past the right or bottom edge of blocked
+ *             storage are skipped.
+ */
+static void map_range(T uarray2, int lo, int hi,
+                      void apply(int col, int row, T a, void *p1, void *p2),
+                      void *cl)
+{
+    size_t size = uarray2->size;
+
+    if (uarray2->order == UArray2_COL_MAJOR) {
+        for (int col = lo; col < hi; col++) {
+            char *curr_element = uarray2->elems + col * uarray2->col_stride;
+
+            for (int row = 0; row < uarray2->height; row++) {
+                apply(col, row, uarray2, curr_element, cl);
+                curr_element += uarray2->row_stride;
+            }
+        }
+        return;
+    }
+
+    if (uarray2->order == UArray2_ROW_MAJOR) {
+        for (int row = lo; row < hi; row++) {
+            char *curr_element = uarray2->elems + row * uarray2->row_stride;
+
+            for (int col = 0; col < uarray2->width; col++) {
+                apply(col, row, uarray2, curr_element, cl);
+                curr_element += uarray2->col_stride;
+            }
+        }
+        return;
+    }
+
+    int side = 1 << uarray2->block_shift;
+
+    for (int block_row = lo; block_row < hi; block_row++) {
+        int row0 = block_row * side;
+        int rows = uarray2->height - row0 < side ? uarray2->height - row0
+                                                 : side;
+
+        for (int block_col = 0; block_col < uarray2->blocks_wide;
+                                                           block_col++) {
+            int col0 = block_col * side;
+            int cols = uarray2->width - col0 < side ? uarray2->width - col0
+                                                    : side;
+            char *block = uarray2->elems
+                          + ((size_t)block_row * uarray2->blocks_wide
+                             + block_col) * uarray2->block_bytes;
+
+            for (int r = 0; r < rows; r++) {
+                char *curr_element = block + (size_t)r * side * size;
+
+                for (int c = 0; c < cols; c++) {
+                    apply(col0 + c, row0 + r, uarray2, curr_element, cl);
+                    curr_element += size;
+                }
+            }
+        }
+    }
+}
+
+/* padded_line
+ *    Purpose: Rounds the length of a column or row up to the padding
+ *             used by new arrays
+ * Parameters: the length in bytes
+ *    Returns: the padded length
+ */
+static size_t padded_line(size_t bytes)
+{
+    return (bytes + UARRAY2_ALIGN - 1) & ~(size_t)(UARRAY2_ALIGN - 1);
+}
+
+/* gather_line
+ *    Purpose: Copies one column (column-major) or row (row-major) of a
+ *             UArray2 into a contiguous buffer
+ * Parameters: the UArray2, the index of the column or row, and the
+ *             buffer, which must hold the whole line
+ *    Returns: void
+ */
+static void gather_line(T uarray2, int line, char *buf)
+{
+    int length = uarray2->order == UArray2_COL_MAJOR ? uarray2->height
+                                                     : uarray2->width;
+
+    for (int i = 0; i < length; i++) {
+        char *elem = uarray2->order == UArray2_COL_MAJOR
+                     ? element_at(uarray2, line, i)
+                     : element_at(uarray2, i, line);
+
+        memcpy(buf + i * uarray2->size, elem, uarray2->size);
+    }
+}
+
+/* fill_header
+ *    Purpose: Fills in the fields of an arrayfile header that describe a
+ *             UArray2, leaving the checksum unset
+ * Parameters: the UArray2 and the header to fill in
+ *    Returns: void
+ */
+static void fill_header(T uarray2, ArrayFile_header *header)
+{
+    header->kind = ArrayFile_UARRAY2;
+    header->elem_size = uarray2->size;
+    header->width = uarray2->width;
+    header->height = uarray2->height;
+
+    if (uarray2->order == UArray2_COL_MAJOR) {
+        header->layout = ArrayFile_COL_MAJOR;
+        header->stride = padded_line(uarray2->height * uarray2->size);
+        header->payload_size = uarray2->width * header->stride;
+    } else if (uarray2->order == UArray2_ROW_MAJOR) {
+        header->layout = ArrayFile_ROW_MAJOR;
+        header->stride = padded_line(uarray2->width * uarray2->size);
+        header->payload_size = uarray2->height * header->stride;
+    } else {
+        header->layout = ArrayFile_BLOCKED;
+        header->stride = uarray2->block_bytes;
+        header->payload_size = uarray2->elems_size;
+    }
+}
+
+/* header_order
+ *    Purpose: Works out the storage order of a saved UArray2
+ * Parameters: the file's header and a pointer to an int for the log2 of
+ *             the block side
+ *    Returns: the storage order; the block shift is 0 unless the order
+ *             is blocked
+ */
+static UArray2_order header_order(ArrayFile_header *header,
+                                  int *block_shift)
+{
+    *block_shift = 0;
+
+    if (header->layout == ArrayFile_ROW_MAJOR) {
+        return UArray2_ROW_MAJOR;
+    } else if (header->layout == ArrayFile_BLOCKED) {
+        while (*block_shift < 15 && ((uint64_t)header->elem_size
+                                     << (2 * *block_shift))
+                                    < header->stride) {
+            (*block_shift)++;
+        }
+        return UArray2_BLOCKED;
+    }
+
+    assert (header->layout == ArrayFile_COL_MAJOR);
+    return UArray2_COL_MAJOR;
+}
+
+/* map_file
+ *    Purpose: Maps the header and payload of an arrayfile into memory
+ *             and builds a UArray2 whose elements are the payload
+ * Parameters: an open descriptor for the file, its validated header, and
+ *             whether the mapping may be written
+ *    Returns: the new UArray2
+ */
+static T map_file(int fd, ArrayFile_header *header, int writable)
+{
+    assert (header->width <= INT_MAX && header->height <= INT_MAX);
+    assert (header->elem_size > 0 && header->elem_size <= INT_MAX);
+
+    T uarray2 = malloc(sizeof(struct T));
+    assert (uarray2 != NULL);
+
+    int block_shift;
+    UArray2_order order = header_order(header, &block_shift);
+    set_shape(uarray2, header->width, header->height, header->elem_size,
+              order, block_shift);
+
+    /* The payload is used in place, so it must be padded exactly as
+     * set_shape pads it */
+    ArrayFile_header expected;
+    fill_header(uarray2, &expected);
+    assert (header->stride == expected.stride);
+    assert (header->payload_size == uarray2->elems_size);
+
+    struct stat info;
+    size_t map_bytes = sizeof(ArrayFile_header) + uarray2->elems_size;
+    int status = fstat(fd, &info);
+    assert (status == 0);
+    assert ((uintmax_t)info.st_size >= map_bytes);
+
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *map = mmap(NULL, map_bytes, prot, MAP_SHARED, fd, 0);
+    assert (map != MAP_FAILED);
+
+    /* Mappings start on a page, and the header is UARRAY2_ALIGN bytes,
+     * so the payload stays aligned */
+    uarray2->map = map;
+    uarray2->map_bytes = map_bytes;
+    uarray2->map_writable = writable;
+    uarray2->elems = uarray2->map + sizeof(ArrayFile_header);
+
+    return uarray2;
+}
+
+/* transpose_range
+ *    Purpose: Transposes the source rectangle with its top left corner
+ *             at (col, row) into the destination, halving the longer
+ *             side until the rectangle is one tile
+ * Parameters: the destination and source, the column and row of the
+ *             rectangle, and its width and height
+ *    Returns: void
+ */
+static void transpose_range(T dst, T src, int col, int row, int cols,
+                            int rows)
+{
+    if (cols <= TRANSPOSE_SIDE && rows <= TRANSPOSE_SIDE) {
+        transpose_tile(dst, src, col, row, cols, rows);
+    } else if (cols >= rows) {
+        int half = cols / 2;
+        transpose_range(dst, src, col, row, half, rows);
+        transpose_range(dst, src, col + half, row, cols - half, rows);
+    } else {
+        int half = rows / 2;
+        transpose_range(dst, src, col, row, cols, half);
+        transpose_range(dst, src, col, row + half, cols, rows - half);
+    }
+}
+
+/* Copies a tile one TYPE at a time: source (col, row) goes to
+ * destination (row, col). Used by transpose_tile only. */
+#define TRANSPOSE_LOOP(TYPE)                                                 \
+    for (int c = 0; c < cols; c++) {                                         \
+        const char *in = from + c * src->col_stride;                         \
+        char *out = to + c * dst->row_stride;                                \
+        for (int r = 0; r < rows; r++) {                                     \
+            *(TYPE *)(out + r * dst->col_stride) =                           \
+                *(const TYPE *)(in + r * src->row_stride);                   \
+        }                                                                    \
+    }
+
+/* transpose_tile
+ *    Purpose: Transposes one tile of at most TRANSPOSE_SIDE squared
+ *             elements, with a typed loop for 1-, 2-, 4- and 8-byte
+ *             elements
+ * Parameters: the destination and source, the column and row of the
+ *             tile in the source, and its width and height
+ *    Returns: void
+ */
+static void transpose_tile(T dst, T src, int col, int row, int cols,
+                           int rows)
+{
+    size_t size = src->size;
+
+    /* Blocked arrays have no strides to step by */
+    if (dst->order == UArray2_BLOCKED || src->order == UArray2_BLOCKED) {
+        for (int c = col; c < col + cols; c++) {
+            for (int r = row; r < row + rows; r++) {
+                memcpy(element_at(dst, r, c), element_at(src, c, r), size);
+            }
+        }
+        return;
+    }
+
+    const char *from = element_at(src, col, row);
+    char *to = element_at(dst, row, col);
+
+    switch (size) {
+    case 1:
+        TRANSPOSE_LOOP(uint8_t)
+        break;
+    case 2:
+        TRANSPOSE_LOOP(uint16_t)
+        break;
+    case 4:
+        TRANSPOSE_LOOP(uint32_t)
+        break;
+    case 8:
+        TRANSPOSE_LOOP(uint64_t)
+        break;
+    default:
+        for (int c = 0; c < cols; c++) {
+            for (int r = 0; r < rows; r++) {
+                memcpy(to + c * dst->row_stride + r * dst->col_stride,
+                       from + c * src->col_stride + r * src->row_stride,
+                       size);
+            }
+        }
+    }
+}
+
+#undef TRANSPOSE_LOOP
+
+/* Swaps (col + c, row + r) with (row + r, col + c) one TYPE at a time,
+ * only below the diagonal when the tile is on it. Used by swap_tile
+ * only. */
+#define SWAP_LOOP(TYPE)                                                      \
+    for (int c = 0; c < cols; c++) {                                         \
+        for (int r = diagonal ? c + 1 : 0; r < rows; r++) {                  \
+            TYPE *a = (TYPE *)(corner + c * cs + r * rs);                    \
+            TYPE *b = (TYPE *)(mirror + r * cs + c * rs);                    \
+            TYPE tmp = *a;                                                   \
+            *a = *b;                                                         \
+            *b = tmp;                                                        \
+        }                                                                    \
+    }
+
+/* swap_tile
+ *    Purpose: Swaps a tile of a square UArray2 with its mirror image
+ *             across the diagonal, or transposes it in place if it is on
+ *             the diagonal
+ * Parameters: the UArray2, the column and row of the tile (row >= col),
+ *             and its width and height
+ *    Returns: void
+ */
+static void swap_tile(T uarray2, int col, int row, int cols, int rows)
+{
+    int diagonal = (col == row);
+    size_t size = uarray2->size;
+
+    if (uarray2->order == UArray2_BLOCKED || size > 8
+                                          || (size & (size - 1)) != 0) {
+        for (int c = 0; c < cols; c++) {
+            for (int r = diagonal ? c + 1 : 0; r < rows; r++) {
+                char *a = element_at(uarray2, col + c, row + r);
+                char *b = element_at(uarray2, row + r, col + c);
+                for (size_t i = 0; i < size; i++) {
+                    char tmp = a[i];
+                    a[i] = b[i];
+                    b[i] = tmp;
+                }
+            }
+        }
+        return;
+    }
+
+    char *corner = element_at(uarray2, col, row);
+    char *mirror = element_at(uarray2, row, col);
+    size_t cs = uarray2->col_stride;
+    size_t rs = uarray2->row_stride;
+
+    switch (size) {
+    case 1:
+        SWAP_LOOP(uint8_t)
+        break;
+    case 2:
+        SWAP_LOOP(uint16_t)
+        break;
+    case 4:
+        SWAP_LOOP(uint32_t)
+        break;
+    default:
+        SWAP_LOOP(uint64_t)
+    }
+}
+
+#undef SWAP_LOOP
@@ -10,6 +10,13 @@
  *     The UArray2 interface is an abstraction that implements
  *     two-dimensional, polymorphic, unboxed arrays. The abstraction
  *     is based on Dave Hanson's one-dimensional unboxed array, UArray.
+ *     All elements are kept in a single 64-byte-aligned block, so a
+ *     whole array is one allocation. The elements are stored column by
+ *     column unless another UArray2_order is chosen at creation;
+ *     UArray2_map_default always walks memory sequentially, whichever
+ *     order was chosen. Rows or columns can also be reached as strided
+ *     pointers, so kernels can run over them with memcpy or vector
+ *     loops instead of calling UArray2_at per element.
  *
  **************************************************************/
 
@@ -18,12 +25,34 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <uarray.h>
 #include <assert.h>
+#include <pool.h>
 #define T UArray2_T
 
+/* Every column of a column-major UArray2, and every row of a row-major
+ * one, starts on a multiple of this many bytes */
+#define UARRAY2_ALIGN 64
+
 typedef struct T *T;
 
+/* How the elements of a UArray2 are laid out in memory */
+typedef enum {
+    UArray2_COL_MAJOR,      /* one column after another (the default) */
+    UArray2_ROW_MAJOR,      /* one row after another */
+    UArray2_BLOCKED         /* square blocks of at most 4 KB, in row-major
+                               order, each stored row by row */
+} UArray2_order;
+
+/* How the elements of a file-backed UArray2 will be used; passed on to
+ * the kernel as the matching POSIX_MADV_* advice */
+typedef enum {
+    UArray2_ADVISE_NORMAL,
+    UArray2_ADVISE_SEQUENTIAL,  /* read ahead aggressively */
+    UArray2_ADVISE_RANDOM,      /* do not read ahead */
+    UArray2_ADVISE_WILLNEED,    /* start paging everything in now */
+    UArray2_ADVISE_DONTNEED     /* the pages may be dropped for now */
+} UArray2_advice;
+
 /* UArray2_new
  * Purpose: Creates a new UArray2 of a given width and height that
  *          can store elements of the given size.
@@ -38,6 +67,47 @@ typedef struct T *T;
  */
 T UArray2_new(int width, int height, size_t size);
 
+/* UArray2_new_order
+ * Purpose: Creates a new UArray2 whose elements are stored in a chosen
+ *          order
+ * Parameters: integers representing width and height of the UArray2, a
+ *             size_t representing the size of each element, and the
+ *             UArray2_order to store the elements in
+ * Returns: the new UArray2
+ * Expected input: a width, height, and size that are all greater than 0
+ *                 and one of the UArray2_order values
+ * Success output: a new UArray2 is returned; UArray2_new(w, h, size) is
+ *                 UArray2_new_order(w, h, size, UArray2_COL_MAJOR)
+ * Failure output: if the width, height, size or order are invalid, a
+ *                 Hanson CRE is raised
+ *           Note: Blocks are the largest power-of-two square that fits
+ *                 in 4 KB (32 x 32 for 4-byte elements). Blocked arrays
+ *                 are padded to whole blocks.
+ */
+T UArray2_new_order(int width, int height, size_t size,
+                    UArray2_order order);
+
+/* UArray2_new_pool
+ * Purpose: Creates a new UArray2 whose storage comes from a Pool
+ * Parameters: integers representing width and height of the UArray2, a
+ *             size_t representing the size of each element, the
+ *             UArray2_order to store the elements in, and the Pool to
+ *             allocate from, or NULL for the heap
+ * Returns: the new UArray2
+ * Expected input: the same as UArray2_new_order, plus a valid Pool or
+ *                 NULL
+ * Success output: a new, zero-filled UArray2 is returned; with a NULL
+ *                 Pool this is UArray2_new_order
+ * Failure output: if the width, height, size or order are invalid, a
+ *                 Hanson CRE is raised
+ *           Note: A pooled UArray2 lives until its Pool is reset or
+ *                 freed. UArray2_free on it is allowed and does nothing,
+ *                 so code can free arrays the same way wherever they
+ *                 came from.
+ */
+T UArray2_new_pool(int width, int height, size_t size, UArray2_order order,
+                   Pool_T pool);
+
 /* UArray2_at
  * Purpose: Returns a pointer to the target element of a given UArray2
  * Parameters: The UArray2, two integers for the column and row the target
@@ -51,6 +121,45 @@ T UArray2_new(int width, int height, size_t size);
  */
 void *UArray2_at(T uarray2, int col, int row);
 
+/* UArray2_view
+ * Purpose: Creates a view onto a rectangle of an existing UArray2 without
+ *          copying any elements
+ * Parameters: the parent UArray2, two ints for the column and row of the
+ *             rectangle's top left element, and two ints for its width
+ *             and height
+ * Returns: the new view, which is itself a UArray2_T
+ * Expected input: a valid UArray2 that is not blocked and a rectangle
+ *                 within its bounds
+ * Success output: a UArray2 whose element (i, j) is the parent's element
+ *                 (col + i, row + j); writes through either show in both
+ * Failure output: if the parent is null or blocked, or if the rectangle
+ *                 is empty or out of bounds, a Hanson CRE is raised
+ *           Note: A view takes O(1) time and memory, works with every
+ *                 UArray2 function, and may itself be viewed. It is
+ *                 valid only while its parent is, and must be freed with
+ *                 UArray2_free.
+ */
+T UArray2_view(T parent, int col, int row, int width, int height);
+
+/* UArray2_view_strided
+ * Purpose: Creates a view onto every col_step-th column and row_step-th
+ *          row of a rectangle of an existing UArray2
+ * Parameters: the parent UArray2, two ints for the column and row of the
+ *             view's first element, two ints for the view's width and
+ *             height, and two ints for the column and row steps
+ * Returns: the new view
+ * Expected input: a valid UArray2 that is not blocked, positive steps,
+ *                 and a view whose last element is within the parent
+ * Success output: a UArray2 whose element (i, j) is the parent's element
+ *                 (col + i * col_step, row + j * row_step)
+ * Failure output: if the parent is null or blocked, if a step is not
+ *                 positive, or if the view is empty or out of bounds, a
+ *                 Hanson CRE is raised
+ *           Note: As for UArray2_view
+ */
+T UArray2_view_strided(T parent, int col, int row, int width, int height,
+                       int col_step, int row_step);
+
 /* UArray2_width
  * Purpose: Returns the width of a given UArray2
  * Parameters: the UArray2
@@ -81,6 +190,125 @@ int UArray2_height(T uarray2);
  */
 int UArray2_size(T uarray2);
 
+/* UArray2_storage
+ * Purpose: Returns the order in which a UArray2's elements are stored
+ * Parameters: the UArray2
+ * Returns: the UArray2_order given when the UArray2 was created
+ * Expected input: a valid UArray2
+ * Success output: the storage order, which tells callers which map
+ *                 function reads memory sequentially
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+UArray2_order UArray2_storage(T uarray2);
+
+/* UArray2_blocksize
+ * Purpose: Returns the side of the square blocks of a UArray2
+ * Parameters: the UArray2
+ * Returns: the number of elements along one side of a block
+ * Expected input: a valid UArray2
+ * Success output: the block side, or 1 if the storage is not blocked
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+int UArray2_blocksize(T uarray2);
+
+/* UArray2_row
+ * Purpose: Returns a pointer to the first element of a row, with the
+ *          distance between its elements and its length
+ * Parameters: the UArray2, an int for the row, a pointer to a size_t for
+ *             the stride in bytes, and a pointer to an int for the
+ *             number of elements
+ * Returns: a void pointer to element (0, row)
+ * Expected input: a valid UArray2 that is not blocked and a row within
+ *                 its bounds; either out pointer may be null
+ * Success output: element (col, row) is at the pointer plus col * stride,
+ *                 and the length is the width. In a row-major UArray2 the
+ *                 stride is the element size, so the row is contiguous,
+ *                 and the pointer is a multiple of UARRAY2_ALIGN unless
+ *                 the UArray2 is a view.
+ * Failure output: if the UArray2 is null or blocked, or if the row is out
+ *                 of bounds, a Hanson CRE is raised
+ */
+void *UArray2_row(T uarray2, int row, size_t *stride, int *length);
+
+/* UArray2_col
+ * Purpose: Returns a pointer to the first element of a column, with the
+ *          distance between its elements and its length
+ * Parameters: the UArray2, an int for the column, a pointer to a size_t
+ *             for the stride in bytes, and a pointer to an int for the
+ *             number of elements
+ * Returns: a void pointer to element (col, 0)
+ * Expected input: a valid UArray2 that is not blocked and a column within
+ *                 its bounds; either out pointer may be null
+ * Success output: element (col, row) is at the pointer plus row * stride,
+ *                 and the length is the height. In a column-major UArray2
+ *                 the column is contiguous and the pointer is a multiple
+ *                 of UARRAY2_ALIGN unless the UArray2 is a view.
+ * Failure output: if the UArray2 is null or blocked, or if the column is
+ *                 out of bounds, a Hanson CRE is raised
+ */
+void *UArray2_col(T uarray2, int col, size_t *stride, int *length);
+
+/* UArray2_copy_row
+ * Purpose: Copies every element of one row into a row of another (or the
+ *          same) UArray2
+ * Parameters: the destination UArray2 and row, and the source UArray2
+ *             and row
+ * Returns: none
+ * Expected input: two valid UArray2s of the same width and element size
+ *                 and rows within their bounds; any storage orders
+ * Success output: the destination row holds a copy of the source row,
+ *                 copied with one memcpy when both are row-major
+ * Failure output: if either UArray2 is null, the widths or sizes differ,
+ *                 or a row is out of bounds, a Hanson CRE is raised
+ */
+void UArray2_copy_row(T dst, int dst_row, T src, int src_row);
+
+/* UArray2_fill_row
+ * Purpose: Sets every element of a row to a copy of one value
+ * Parameters: the UArray2, an int for the row, and a pointer to the value
+ * Returns: none
+ * Expected input: a valid UArray2, a row within its bounds, and a
+ *                 pointer to UArray2_size bytes
+ * Success output: every element of the row equals the value
+ * Failure output: if the UArray2 or value is null, or if the row is out
+ *                 of bounds, a Hanson CRE is raised
+ */
+void UArray2_fill_row(T uarray2, int row, const void *elem);
+
+/* UArray2_transpose
+ * Purpose: Copies the transpose of one UArray2 into another
+ * Parameters: the destination UArray2 and the source UArray2
+ * Returns: none
+ * Expected input: two different UArray2s that do not share elements,
+ *                 with the same element size, where the destination is
+ *                 as wide as the source is high and as high as it is
+ *                 wide; any storage orders
+ * Success output: element (row, col) of the destination is a copy of
+ *                 element (col, row) of the source
+ * Failure output: if either UArray2 is null, they are the same UArray2,
+ *                 or their sizes do not match, a Hanson CRE is raised
+ *           Note: The copy is cache-oblivious: it halves the longer side
+ *                 until a tile of each array fits in cache, then copies
+ *                 the tile with a typed loop for 1-, 2-, 4- and 8-byte
+ *                 elements. Transposing a column-major array into a
+ *                 row-major one of the same shape is a plain copy in
+ *                 memory order.
+ */
+void UArray2_transpose(T dst, T src);
+
+/* UArray2_transpose_square
+ * Purpose: Transposes a square UArray2 in place
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a valid UArray2 whose width equals its height, in any
+ *                 storage order
+ * Success output: elements (col, row) and (row, col) have been swapped
+ *                 for every col and row, one cache-sized tile at a time
+ * Failure output: if the UArray2 is null or is not square, a Hanson CRE
+ *                 is raised
+ */
+void UArray2_transpose_square(T uarray2);
+
 /* UArray2_map_col_major
  * Purpose: Traverse a given UArray2 column by column starting from 
  *             the top left element, calling the apply function on each
@@ -125,6 +353,255 @@ void UArray2_map_col_major(T uarray2, void apply(int col, int row, T a,
 void UArray2_map_row_major(T uarray2, void apply(int col, int row, T a,
                                         void *p1, void *p2), void *cl);
 
+/* UArray2_map_default
+ * Purpose: Traverse a given UArray2 in the order its elements are
+ *             stored, calling the apply function on each element and
+ *             building up the closure value across iterations
+ * Parameters: the UArray2, function pointer to the function to apply to
+ *             each element, and void pointer to the closure value that is
+ *             aggregated across the traversal
+ * Returns: none
+ * Expected input: a valid UArray2, a function pointer with matching
+ *                 apply function parameters, and either a closure
+ *                 pointer or a null closure parameter
+ * Success output: none
+ * Failure output: if either the UArray2 or the apply function are null, a
+ *                 Hanson CRE is raised
+ *           Note: This is UArray2_map_col_major or UArray2_map_row_major
+ *                 for those storage orders. Blocked arrays are visited
+ *                 block by block, each block row by row. Every element is
+ *                 visited exactly once.
+ */
+void UArray2_map_default(T uarray2, void apply(int col, int row, T a,
+                                        void *p1, void *p2), void *cl);
+
+/* UArray2_map_block_major
+ * Purpose: Traverse a given UArray2 one square tile at a time, calling
+ *             the apply function on each element and building up the
+ *             closure value across iterations, so that an apply function
+ *             reading neighbors in both directions stays in cache
+ * Parameters: the UArray2, an int for the side of a tile in elements (0
+ *             uses UArray2_default_tile), function pointer to the
+ *             function to apply to each element, and void pointer to the
+ *             closure value that is aggregated across the traversal
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative tile side, a function
+ *                 pointer with matching apply function parameters, and
+ *                 either a closure pointer or a null closure parameter
+ * Success output: none
+ * Failure output: if either the UArray2 or the apply function are null,
+ *                 or if the tile side is negative, a Hanson CRE is raised
+ *           Note: Tiles start at multiples of the tile side; the last
+ *                 tile of a row or column of tiles may be cut short.
+ *                 Tiles, and the elements inside each tile, are visited
+ *                 column by column for column-major storage and row by
+ *                 row otherwise, so each tile is read sequentially.
+ */
+void UArray2_map_block_major(T uarray2, int tile,
+                             void apply(int col, int row, T a,
+                                        void *p1, void *p2), void *cl);
+
+/* UArray2_default_tile
+ * Purpose: Returns the tile side UArray2_map_block_major uses by default
+ * Parameters: the UArray2
+ * Returns: the tile side in elements
+ * Expected input: a valid UArray2
+ * Success output: the block side for blocked storage; otherwise the
+ *                 largest power of two whose square tile fits in 16 KB,
+ *                 half of a typical L1 data cache (64 for 4-byte
+ *                 elements, 32 for 16-byte elements)
+ * Failure output: if the UArray2 is null, a Hanson CRE is raised
+ */
+int UArray2_default_tile(T uarray2);
+
+/* UArray2_map_parallel
+ * Purpose: Traverse a given UArray2 with a pool of worker threads that
+ *             claim chunks of whole columns, rows or block rows in
+ *             storage order as they free up, so uneven per-element costs
+ *             stay balanced, calling the apply function on each element
+ *             with the worker's own copy of the closure value, then
+ *             folding the per-worker closures back into the caller's
+ *             closure
+ * Parameters: the UArray2, the number of worker threads (0 uses one per
+ *             online processor), function pointer to the thread-safe
+ *             function to apply to each element, void pointer to the
+ *             closure value, the size of the closure in bytes, and
+ *             function pointer to the reduce function
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative thread count, a
+ *                 function pointer with matching apply function
+ *                 parameters, and either a closure of cl_size bytes or a
+ *                 null closure with a cl_size of 0
+ * Success output: none
+ * Failure output: if either the UArray2 or the apply function are null,
+ *                 or if the thread count is negative, a Hanson CRE is
+ *                 raised
+ *           Note: When cl_size is nonzero, every worker starts from a
+ *                 byte copy of *cl, and after all workers finish, reduce
+ *                 is called once per worker, in worker order, on the
+ *                 calling thread with cl and that worker's copy. Which
+ *                 chunks a worker ran varies from run to run, so the
+ *                 result is deterministic when reduce is associative and
+ *                 commutative; UArray2_reduce_parallel gives the same
+ *                 result for any combine. A null reduce discards the
+ *                 copies. When cl_size is 0 all workers share cl and
+ *                 reduce is never called.
+ */
+void UArray2_map_parallel(T uarray2, int num_threads,
+                          void apply(int col, int row, T a,
+                                     void *p1, void *p2),
+                          void *cl, size_t cl_size,
+                          void reduce(void *cl, void *thread_cl));
+
+/* UArray2_reduce_parallel
+ * Purpose: Folds every element of a UArray2 into a single result on a
+ *          pool of worker threads, with dynamic load balancing and a
+ *          result that does not depend on the number of threads
+ * Parameters: the UArray2, the number of worker threads (0 uses one per
+ *             online processor), function pointer to the thread-safe
+ *             function that folds one element into a partial result,
+ *             void pointer to the identity value of a partial result,
+ *             void pointer to the result, the size of a result in bytes,
+ *             and function pointer to the combine function
+ * Returns: none
+ * Expected input: a valid UArray2, a non-negative thread count, non-null
+ *                 apply and combine functions, and identity and result
+ *                 values of result_size bytes each
+ * Success output: every partial result has been combined into *result
+ * Failure output: if any pointer is null, the result size is 0, or the
+ *                 thread count is negative, a Hanson CRE is raised
+ *           Note: The array is cut into chunks of whole columns, rows or
+ *                 block rows (following the storage order) of about 16K
+ *                 elements, and idle workers claim the next chunk, so
+ *                 costly regions do not stall one worker. Each chunk
+ *                 starts from a byte copy of *identity, and apply is
+ *                 called on its elements in storage order with the
+ *                 element and the chunk's partial. combine(result,
+ *                 partial) is then called on the calling thread for
+ *                 every chunk in order. Chunks depend only on the
+ *                 array's shape, so even floating-point reductions give
+ *                 the same bits for any thread count.
+ */
+void UArray2_reduce_parallel(T uarray2, int num_threads,
+                             void apply(int col, int row, T a,
+                                        void *p1, void *p2),
+                             const void *identity, void *result,
+                             size_t result_size,
+                             void combine(void *result, void *partial));
+
+/* UArray2_save
+ * Purpose: Writes a UArray2 to a file in the binary arrayfile format
+ * Parameters: the UArray2 and a file pointer for the output stream
+ * Returns: none
+ * Expected input: a valid UArray2 and a stream open for binary writing
+ * Success output: a 64-byte header followed by the raw elements, in
+ *                 storage order, is written with one write; a view is
+ *                 gathered a line at a time and written as if it were a
+ *                 copy
+ * Failure output: if the UArray2 or file pointer is null, or if the
+ *                 write fails, a Hanson CRE is raised
+ *           Note: Elements are saved as raw bytes, so they must not
+ *                 contain pointers.
+ */
+void UArray2_save(T uarray2, FILE *fp);
+
+/* UArray2_load
+ * Purpose: Reads a UArray2 written by UArray2_save
+ * Parameters: a file pointer for the input stream
+ * Returns: the new UArray2
+ * Expected input: a stream positioned at the start of a saved UArray2
+ * Success output: a UArray2 with the saved dimensions, size and elements
+ * Failure output: if the file pointer is null, if the read fails, or if
+ *                 the header or checksum is invalid, a Hanson CRE is
+ *                 raised
+ */
+T UArray2_load(FILE *fp);
+
+/* UArray2_new_file
+ * Purpose: Creates a new UArray2 whose elements live in a memory-mapped
+ *          file rather than in memory
+ * Parameters: a string for the path of the file, the width, height and
+ *             element size, and the UArray2_order
+ * Returns: the new UArray2
+ * Expected input: a path that can be created or overwritten and the same
+ *                 sizes and orders as UArray2_new_order
+ * Success output: the file holds an arrayfile header followed by the
+ *                 zero-filled elements; pages are read and written by
+ *                 the kernel on demand, so the array may be larger than
+ *                 memory
+ * Failure output: if the path is null, the sizes are invalid, or the
+ *                 file cannot be created, sized or mapped, a Hanson CRE
+ *                 is raised
+ *           Note: The file is in the UArray2_save format, so it can be
+ *                 reopened with UArray2_open_file or read with
+ *                 UArray2_load once it has been synced or freed. It is
+ *                 marked unsealed, so UArray2_load skips the checksum
+ *                 until UArray2_seal fills it in.
+ */
+T UArray2_new_file(const char *path, int width, int height, size_t size,
+                   UArray2_order order);
+
+/* UArray2_open_file
+ * Purpose: Maps a saved UArray2 back into memory without reading or
+ *          copying its elements
+ * Parameters: a string for the path of the file and an int that is
+ *             nonzero if the elements may be changed
+ * Returns: the new UArray2
+ * Expected input: a file written by UArray2_save or UArray2_new_file
+ *                 with the padding this build uses
+ * Success output: a UArray2 whose elements are the file's payload;
+ *                 changes are written back to the file if writable is
+ *                 nonzero and are not allowed otherwise
+ * Failure output: if the path is null, the file cannot be opened or
+ *                 mapped, or the header is invalid, a Hanson CRE is
+ *                 raised
+ *           Note: Opening takes O(1) time because the checksum is not
+ *                 verified; use UArray2_load for a checked read. Opening
+ *                 for writing marks the file unsealed until UArray2_seal.
+ */
+T UArray2_open_file(const char *path, int writable);
+
+/* UArray2_advise
+ * Purpose: Tells the kernel how the elements of a file-backed UArray2
+ *          will be accessed
+ * Parameters: the UArray2 and a UArray2_advice
+ * Returns: none
+ * Expected input: a UArray2 from UArray2_new_file or UArray2_open_file
+ * Success output: read-ahead and caching follow the advice
+ * Failure output: if the UArray2 is null or not file-backed, or if the
+ *                 advice is invalid, a Hanson CRE is raised
+ */
+void UArray2_advise(T uarray2, UArray2_advice advice);
+
+/* UArray2_sync
+ * Purpose: Flushes the elements of a file-backed UArray2 to its file
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a UArray2 from UArray2_new_file or UArray2_open_file
+ * Success output: every changed page has reached the file when
+ *                 UArray2_sync returns; a read-only UArray2 is left alone
+ * Failure output: if the UArray2 is null or not file-backed, or if the
+ *                 flush fails, a Hanson CRE is raised
+ *           Note: Only dirty pages are written and the checksum is left
+ *                 stale, so syncing a huge array costs what was changed.
+ */
+void UArray2_sync(T uarray2);
+
+/* UArray2_seal
+ * Purpose: Fills in the checksum of a file-backed UArray2 and flushes it
+ * Parameters: the UArray2
+ * Returns: none
+ * Expected input: a writable UArray2 from UArray2_new_file or
+ *                 UArray2_open_file
+ * Success output: the file holds a checksum that UArray2_load verifies,
+ *                 as if written by UArray2_save, and has been synced
+ * Failure output: if the UArray2 is null, not file-backed or read-only,
+ *                 or if the flush fails, a Hanson CRE is raised
+ *           Note: Sealing reads every element once, so it is never done
+ *                 implicitly; call it after the last change.
+ */
+void UArray2_seal(T uarray2);
+
 /* UArray2_free
  * Purpose: Frees memory associated with a given UArray2, including the
  *          elements stored inside of it.
@@ -134,6 +611,10 @@ void UArray2_map_row_major(T uarray2, void apply(int col, int row, T a,
  * Success output: none
  * Failure output: if either the UArray2 pointer or the UArray2 itself
  *                 are null, a Hanson CRE is raised
+ *           Note: Freeing a view frees only the view, never the
+ *                 elements it shares with its parent. Freeing a
+ *                 file-backed UArray2 syncs and unmaps it without
+ *                 sealing it.
  */
 void UArray2_free(T *uarray2);
 
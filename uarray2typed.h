@@ -0,0 +1,230 @@
+/**************************************************************
+ *
+ *                     uarray2typed.h
+ *
+ *     Assignment: iii
+ *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
+ *     Date:     Oct 18, 2026
+ *
+ *     Summary
+ *     Typed UArray2 variants. UARRAY2_TYPED(NAME, TYPE) generates a
+ *     NAME_T handle and static inline functions mirroring the
+ *     UArray2 interface, but with the element type known at compile
+ *     time: accessors return TYPE * instead of void *, and the map
+ *     functions step a TYPE pointer, so the compiler can inline and
+ *     vectorize element access. Each variant is a thin wrapper
+ *     around an ordinary UArray2, which NAME_generic exposes for
+ *     saving, parallel maps and everything else.
+ *
+ *     Variants for uint8_t, uint16_t, int32_t and float are
+ *     generated below as UArray2_u8, UArray2_u16, UArray2_i32 and
+ *     UArray2_f32.
+ *
+ **************************************************************/
+
+#ifndef __UARRAY2TYPED__
+#define __UARRAY2TYPED__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <uarray2.h>
+#include <pool.h>
+
+/* UARRAY2_TYPED
+ * Purpose: Generates a typed UArray2 variant
+ * Parameters: the name of the variant and the element type
+ * Expected input: an element type whose size divides UARRAY2_ALIGN
+ *                 (1, 2, 4, 8, 16, 32 or 64 bytes)
+ *
+ * Generated, for NAME and TYPE:
+ *   NAME_T  NAME_new(int width, int height)
+ *   NAME_T  NAME_new_order(int width, int height, UArray2_order order)
+ *   NAME_T  NAME_new_pool(int width, int height, UArray2_order order,
+ *                         Pool_T pool)
+ *   TYPE   *NAME_at(NAME_T a, int col, int row)
+ *   TYPE    NAME_get(NAME_T a, int col, int row)
+ *   void    NAME_put(NAME_T a, int col, int row, TYPE value)
+ *   TYPE   *NAME_row(NAME_T a, int row)
+ *   TYPE   *NAME_col(NAME_T a, int col)
+ *   int     NAME_width(NAME_T a), NAME_height(NAME_T a)
+ *   void    NAME_map_col_major(NAME_T a, apply, void *cl)
+ *   void    NAME_map_row_major(NAME_T a, apply, void *cl)
+ *   void    NAME_map_default(NAME_T a, apply, void *cl)
+ *   UArray2_T NAME_generic(NAME_T a)
+ *   void    NAME_free(NAME_T *a)
+ *
+ * where apply is void apply(int col, int row, NAME_T a, TYPE *elem,
+ * void *cl). They behave as their UArray2 counterparts, including the
+ * Hanson CREs on bad arguments, except that blocked storage is not
+ * supported, so every element is at elems + col * col_step +
+ * row * row_step. NAME_row and NAME_col return the first element of a
+ * row or column; consecutive elements are col_step or row_step
+ * elements apart. With a Pool, NAME_new_pool takes the handle as well
+ * as the UArray2 from the Pool, so nothing is malloc'd; NAME_free then
+ * releases neither, and both go at the next Pool_reset or Pool_free.
+ */
+#define UARRAY2_TYPED(NAME, TYPE)                                            \
+                                                                             \
+typedef struct NAME##_T {                                                    \
+    UArray2_T array;                                                         \
+    TYPE *elems;                                                             \
+    size_t col_step;        /* in elements, not bytes */                     \
+    size_t row_step;                                                         \
+    int width;                                                               \
+    int height;                                                              \
+    int pooled;             /* the handle belongs to a Pool */               \
+} *NAME##_T;                                                                 \
+                                                                             \
+static inline NAME##_T NAME##_new_pool(int width, int height,                \
+                                       UArray2_order order, Pool_T pool)     \
+{                                                                            \
+    assert (order != UArray2_BLOCKED);                                       \
+    assert (UARRAY2_ALIGN % sizeof(TYPE) == 0);                              \
+                                                                             \
+    NAME##_T a = pool != NULL                                                \
+                 ? Pool_alloc(pool, sizeof(struct NAME##_T), sizeof(void *)) \
+                 : malloc(sizeof(struct NAME##_T));                          \
+    assert (a != NULL);                                                      \
+                                                                             \
+    size_t col_bytes, row_bytes;                                             \
+    a->array = UArray2_new_pool(width, height, sizeof(TYPE), order, pool);   \
+    a->elems = UArray2_row(a->array, 0, &col_bytes, NULL);                   \
+    UArray2_col(a->array, 0, &row_bytes, NULL);                              \
+    a->col_step = col_bytes / sizeof(TYPE);                                  \
+    a->row_step = row_bytes / sizeof(TYPE);                                  \
+    a->width = width;                                                        \
+    a->height = height;                                                      \
+    a->pooled = pool != NULL;                                                \
+                                                                             \
+    return a;                                                                \
+}                                                                            \
+                                                                             \
+static inline NAME##_T NAME##_new_order(int width, int height,               \
+                                        UArray2_order order)                 \
+{                                                                            \
+    return NAME##_new_pool(width, height, order, NULL);                      \
+}                                                                            \
+                                                                             \
+static inline NAME##_T NAME##_new(int width, int height)                     \
+{                                                                            \
+    return NAME##_new_pool(width, height, UArray2_COL_MAJOR, NULL);          \
+}                                                                            \
+                                                                             \
+static inline TYPE *NAME##_at(NAME##_T a, int col, int row)                  \
+{                                                                            \
+    assert (a != NULL);                                                      \
+    assert (col >= 0 && col < a->width);                                     \
+    assert (row >= 0 && row < a->height);                                    \
+                                                                             \
+    return a->elems + col * a->col_step + row * a->row_step;                 \
+}                                                                            \
+                                                                             \
+static inline TYPE NAME##_get(NAME##_T a, int col, int row)                  \
+{                                                                            \
+    return *NAME##_at(a, col, row);                                          \
+}                                                                            \
+                                                                             \
+static inline void NAME##_put(NAME##_T a, int col, int row, TYPE value)      \
+{                                                                            \
+    *NAME##_at(a, col, row) = value;                                         \
+}                                                                            \
+                                                                             \
+static inline TYPE *NAME##_row(NAME##_T a, int row)                          \
+{                                                                            \
+    assert (a != NULL && row >= 0 && row < a->height);                       \
+                                                                             \
+    return a->elems + row * a->row_step;                                     \
+}                                                                            \
+                                                                             \
+static inline TYPE *NAME##_col(NAME##_T a, int col)                          \
+{                                                                            \
+    assert (a != NULL && col >= 0 && col < a->width);                        \
+                                                                             \
+    return a->elems + col * a->col_step;                                     \
+}                                                                            \
+                                                                             \
+static inline int NAME##_width(NAME##_T a)                                   \
+{                                                                            \
+    assert (a != NULL);                                                      \
+                                                                             \
+    return a->width;                                                         \
+}                                                                            \
+                                                                             \
+static inline int NAME##_height(NAME##_T a)                                  \
+{                                                                            \
+    assert (a != NULL);                                                      \
+                                                                             \
+    return a->height;                                                        \
+}                                                                            \
+                                                                             \
+static inline void NAME##_map_col_major(NAME##_T a,                          \
+                        void apply(int col, int row, NAME##_T a,             \
+                                   TYPE *elem, void *cl), void *cl)          \
+{                                                                            \
+    assert (a != NULL && apply != NULL);                                     \
+                                                                             \
+    for (int col = 0; col < a->width; col++) {                               \
+        TYPE *elem = a->elems + col * a->col_step;                           \
+                                                                             \
+        for (int row = 0; row < a->height; row++) {                          \
+            apply(col, row, a, elem, cl);                                    \
+            elem += a->row_step;                                             \
+        }                                                                    \
+    }                                                                        \
+}                                                                            \
+                                                                             \
+static inline void NAME##_map_row_major(NAME##_T a,                          \
+                        void apply(int col, int row, NAME##_T a,             \
+                                   TYPE *elem, void *cl), void *cl)          \
+{                                                                            \
+    assert (a != NULL && apply != NULL);                                     \
+                                                                             \
+    for (int row = 0; row < a->height; row++) {                              \
+        TYPE *elem = a->elems + row * a->row_step;                           \
+                                                                             \
+        for (int col = 0; col < a->width; col++) {                           \
+            apply(col, row, a, elem, cl);                                    \
+            elem += a->col_step;                                             \
+        }                                                                    \
+    }                                                                        \
+}                                                                            \
+                                                                             \
+static inline void NAME##_map_default(NAME##_T a,                            \
+                        void apply(int col, int row, NAME##_T a,             \
+                                   TYPE *elem, void *cl), void *cl)          \
+{                                                                            \
+    assert (a != NULL);                                                      \
+                                                                             \
+    if (a->row_step == 1) {                                                  \
+        NAME##_map_col_major(a, apply, cl);                                  \
+    } else {                                                                 \
+        NAME##_map_row_major(a, apply, cl);                                  \
+    }                                                                        \
+}                                                                            \
+                                                                             \
+static inline UArray2_T NAME##_generic(NAME##_T a)                           \
+{                                                                            \
+    assert (a != NULL);                                                      \
+                                                                             \
+    return a->array;                                                         \
+}                                                                            \
+                                                                             \
+static inline void NAME##_free(NAME##_T *a)                                  \
+{                                                                            \
+    assert (a != NULL && *a != NULL);                                        \
+                                                                             \
+    UArray2_free(&(*a)->array);                                              \
+    if (!(*a)->pooled) {                                                     \
+        free(*a);                                                            \
+    }                                                                        \
+    *a = NULL;                                                               \
+}
+
+UARRAY2_TYPED(UArray2_u8, uint8_t)
+UARRAY2_TYPED(UArray2_u16, uint16_t)
+UARRAY2_TYPED(UArray2_i32, int32_t)
+UARRAY2_TYPED(UArray2_f32, float)
+
+#endif /* __UARRAY2TYPED__ */
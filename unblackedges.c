@@ -7,6 +7,23 @@
  *     Authors:  Katie Yang (zyang11), Eli Intriligator (eintri01)
  *     Date:     Oct 4, 2021
  *
+ *     Usage:
+ *       unblackedges [-pre OP]... [-post OP]... [-specks N] [-blobs N]
+ *                    [-stats] [pbmfile]
+ *
+ *       OP is erode, dilate, open or close, optionally followed by
+ *       :square or :cross and then :radius (for example open:cross:2).
+ *       The shape defaults to square and the radius to 1. Every -pre
+ *       pass runs, in order, before the black edges are removed, and
+ *       every -post pass runs afterwards, so a despeckle step such as
+ *       -post open:square:1 needs no separate tool.
+ *
+ *       Black edges are found by labeling the 4-connected components
+ *       of black pixels once. The same labeling also removes every
+ *       component of fewer than N pixels (-specks N) or more than N
+ *       pixels (-blobs N, e.g. punch holes), and -stats lists each
+ *       component's area, bounding box and border contact on stderr.
+ *
  *     Input:
  *       A valid pbm file with black edges via arg or stdin
  *
@@ -25,242 +42,373 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <string.h>
+#include <limits.h>
 
 #include <bit2.h>
-#include <seq.h>
-#include <pnmrdr.h>
-
-FILE * OpenFile(int argc, char *argv[]);
+#include <components.h>
+
+typedef struct MorphPass {
+    Bit2_T (*op)(Bit2_T bitmap, Bit2_shape shape, int radius);
+    Bit2_shape shape;
+    int radius;
+} MorphPass;
+
+typedef struct Options {
+    MorphPass *pre;
+    int num_pre;
+    MorphPass *post;
+    int num_post;
+    long min_area;
+    long max_area;
+    bool print_stats;
+    char *filename;
+} Options;
+
+Options parse_options(int argc, char *argv[]);
+MorphPass parse_pass(char *spec);
+long parse_area(char *arg);
+void usage(void);
+Bit2_T run_passes(Bit2_T bitmap, MorphPass *passes, int num_passes);
+
+FILE *OpenFile(char *filename);
 
 Bit2_T pbmread(FILE *fp);
+unsigned read_header_number(FILE *fp);
+void read_plain_row(FILE *fp, unsigned char *row, unsigned width);
 
-void populate_bit2(Bit2_T bitmap, int line_length, short *line_data, 
-                                                      int line_num);
-void remove_black_edges(Bit2_T bitmap);
-void restore_neighbors(Bit2_T bitmap, Seq_T neighbor_queue);
-void find_neighbors(Bit2_T bitmap, Bit2_T queued_map, int col, int row);
-void queue_neighbors(Bit2_T bitmap, Bit2_T queued_map, Seq_T neighbor_queue,
-                                                int curr_col, int curr_row);
-void queue_neighbor(Seq_T neighbor_queue, Bit2_T queued_map, int col, 
-                                                            int row);
+void remove_black_edges(Bit2_T bitmap, Options *options);
+void print_stats(Components_T components);
 
 void pbmwrite(Bit2_T bitmap);
 
-typedef struct BlackPixelData *BlackPixelData;
-
-struct BlackPixelData {
-    int col;
-    int row;
-};
-
 int main(int argc, char *argv[])
 {
-    FILE *fp = OpenFile(argc, argv);
+    Options options = parse_options(argc, argv);
+    FILE *fp = OpenFile(options.filename);
     
     Bit2_T bitmap = pbmread(fp);
+
+    bitmap = run_passes(bitmap, options.pre, options.num_pre);
     
-    remove_black_edges(bitmap);
+    remove_black_edges(bitmap, &options);
+
+    bitmap = run_passes(bitmap, options.post, options.num_post);
     
     pbmwrite(bitmap);
 
     Bit2_free(&bitmap);
+    free(options.pre);
+    free(options.post);
     fclose(fp);
 
     return 0;
 }
 
+/* parse_options
+ *    Purpose: Collect the morphology passes and the input file name from
+ *             the command line
+ * Parameters: number of command line arguments as an int and the
+ *             characters of each argument as a char array
+ *    Returns: the parsed Options; the caller frees its pass arrays
+ *
+ *       Note: Prints a usage message and exits with status 1 if an
+ *             option is malformed or more than one file is named
+ */
+Options parse_options(int argc, char *argv[])
+{
+    Options options;
+    options.pre = malloc(argc * sizeof(MorphPass));
+    options.post = malloc(argc * sizeof(MorphPass));
+    assert(options.pre != NULL && options.post != NULL);
+    options.num_pre = 0;
+    options.num_post = 0;
+    options.min_area = 0;
+    options.max_area = 0;
+    options.print_stats = false;
+    options.filename = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-pre") == 0 && i + 1 < argc) {
+            options.pre[options.num_pre++] = parse_pass(argv[++i]);
+        } else if (strcmp(argv[i], "-post") == 0 && i + 1 < argc) {
+            options.post[options.num_post++] = parse_pass(argv[++i]);
+        } else if (strcmp(argv[i], "-specks") == 0 && i + 1 < argc) {
+            options.min_area = parse_area(argv[++i]);
+        } else if (strcmp(argv[i], "-blobs") == 0 && i + 1 < argc) {
+            options.max_area = parse_area(argv[++i]);
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            options.print_stats = true;
+        } else if (argv[i][0] != '-' && options.filename == NULL) {
+            options.filename = argv[i];
+        } else {
+            usage();
+        }
+    }
+
+    return options;
+}
+
+/* parse_pass
+ *    Purpose: Turn one OP argument such as "open:cross:2" into a MorphPass
+ * Parameters: the OP string
+ *    Returns: the MorphPass it describes
+ *
+ *       Note: Exits through usage if the operator, shape or radius is not
+ *             recognized
+ */
+MorphPass parse_pass(char *spec)
+{
+    MorphPass pass = { NULL, Bit2_SQUARE, 1 };
+    char *field = spec;
+    char *end = strchr(field, ':');
+    size_t length = end == NULL ? strlen(field) : (size_t)(end - field);
+
+    if (length == 5 && strncmp(field, "erode", 5) == 0) {
+        pass.op = Bit2_erode;
+    } else if (length == 6 && strncmp(field, "dilate", 6) == 0) {
+        pass.op = Bit2_dilate;
+    } else if (length == 4 && strncmp(field, "open", 4) == 0) {
+        pass.op = Bit2_open;
+    } else if (length == 5 && strncmp(field, "close", 5) == 0) {
+        pass.op = Bit2_close;
+    } else {
+        usage();
+    }
+
+    if (end != NULL) {
+        field = end + 1;
+        end = strchr(field, ':');
+        length = end == NULL ? strlen(field) : (size_t)(end - field);
+
+        if (length == 6 && strncmp(field, "square", 6) == 0) {
+            pass.shape = Bit2_SQUARE;
+        } else if (length == 5 && strncmp(field, "cross", 5) == 0) {
+            pass.shape = Bit2_CROSS;
+        } else {
+            usage();
+        }
+    }
+
+    if (end != NULL) {
+        char *rest;
+        long radius = strtol(end + 1, &rest, 10);
+
+        if (rest == end + 1 || *rest != '\0' || radius < 0
+                                              || radius > 1000) {
+            usage();
+        }
+        pass.radius = radius;
+    }
+
+    return pass;
+}
+
+/* parse_area
+ *    Purpose: Turn the N argument of -specks or -blobs into a pixel count
+ * Parameters: the argument string
+ *    Returns: the positive area it holds
+ *
+ *       Note: Exits through usage if the argument is not a positive number
+ */
+long parse_area(char *arg)
+{
+    char *rest;
+    long area = strtol(arg, &rest, 10);
+
+    if (rest == arg || *rest != '\0' || area <= 0) {
+        usage();
+    }
+
+    return area;
+}
+
+/* usage
+ *    Purpose: Print how to call the program to stderr and exit
+ * Parameters: none
+ *    Returns: does not return
+ */
+void usage(void)
+{
+    fprintf(stderr, "Usage: unblackedges [-pre OP]... [-post OP]... "
+                    "[-specks N] [-blobs N] [-stats] [pbmfile]\n"
+                    "  OP is erode|dilate|open|close[:square|:cross"
+                    "[:radius]]\n");
+    exit(EXIT_FAILURE);
+}
+
+/* run_passes
+ *    Purpose: Apply a list of morphology passes to a bitmap in order
+ * Parameters: the bitmap, an array of passes, and the number of passes
+ *    Returns: the resulting bitmap; the bitmap passed in is freed if any
+ *             pass ran
+ */
+Bit2_T run_passes(Bit2_T bitmap, MorphPass *passes, int num_passes)
+{
+    for (int i = 0; i < num_passes; i++) {
+        Bit2_T result = passes[i].op(bitmap, passes[i].shape,
+                                             passes[i].radius);
+        Bit2_free(&bitmap);
+        bitmap = result;
+    }
+
+    return bitmap;
+}
+
 /* pbmread
  *    Purpose: Store information from a pbm file in a new bitmap
  * Parameters: a file pointer to the input stream (a file or stdin)
  *    Returns: a bitmap populated with information from the file stream
- *    Expected input: a pointer to a filestream
+ *    Expected input: a pointer to a filestream holding a plain (P1) or
+ *                    raw (P4) pbm
  *    Expected output: populated bitmap should be returned
- * Errors: Throws a CRE if the pbm's width or height are less than 1, or if
- *         the maxval is anything other than 1
+ * Errors: Throws a CRE if the file is not a pbm, if the pbm's width or
+ *         height are less than 1, or if the raster is cut short
+ *
+ *   Note: Each row is packed into P4 bytes and stored with one
+ *         Bit2_put_row, so a raw pbm is read straight into the bitmap
+ *         with one fread per row.
  */
 Bit2_T pbmread(FILE *fp)
 {
-    Pnmrdr_T rdr = Pnmrdr_new(fp);
-    Pnmrdr_mapdata data = Pnmrdr_data(rdr);
-    assert(data.type == 1);
+    int magic = getc(fp);
+    int format = getc(fp);
+    assert(magic == 'P' && (format == '1' || format == '4'));
 
-    unsigned width = data.width;
-    unsigned height = data.height;
-    assert(width > 0 && height > 0 && data.denominator == 1);
+    unsigned width = read_header_number(fp);
+    unsigned height = read_header_number(fp);
+    assert(width > 0 && height > 0);
 
     Bit2_T bitmap = Bit2_new(width, height);
-    
-    for (unsigned int i = 0; i < height; i++) {
-        short *line_data;
-        
-        line_data = malloc(width * sizeof(short));
-        assert(line_data != NULL);
-        
-        unsigned input_num;
-        
-        for (unsigned int j = 0; j < width; j++){
-            input_num = Pnmrdr_get(rdr);
-            assert(input_num == 0 || input_num == 1);
-
-            line_data[j] = input_num;
+    size_t row_bytes = (width + 7) / 8;
+    unsigned char *row = malloc(row_bytes);
+    assert(row != NULL);
+
+    for (unsigned i = 0; i < height; i++) {
+        if (format == '4') {
+            size_t read = fread(row, 1, row_bytes, fp);
+            assert(read == row_bytes);
+        } else {
+            read_plain_row(fp, row, width);
         }
-        
-        populate_bit2(bitmap, width, line_data, i);
-        free(line_data);
+
+        Bit2_put_row(bitmap, i, row);
     }
-    
-    Pnmrdr_free(&rdr);
 
-    return bitmap;
-}
+    free(row);
 
- /* populate_bit2
-  *    Purpose: Populate a line of the bitmap with values from the input file
-  * Parameters: the bitmap, the length of line, a short pointer for a buffer
-  *             that stores the input data, and an int for the taget line
-  *             number in the bitmap
-  *    Returns: void
-  *
-  */
-void populate_bit2(Bit2_T bitmap, int line_length, short *line_data, 
-                                                       int line_num)
-{
-    for (int i = 0; i < line_length; i++) {
-        short curr_num = line_data[i];
-        if (curr_num == 1) {
-            Bit2_put(bitmap, i, line_num, curr_num);
-        }
-    }
+    return bitmap;
 }
 
- /* remove_black_edges
-  *    Purpose: Remove the black edges
-  * Parameters: A bitmap with all the pixels
-  *    Returns: void
-  */
-void remove_black_edges(Bit2_T bitmap)
+/* read_header_number
+ *    Purpose: Read the width or height from a pbm header
+ * Parameters: a file pointer to the input stream
+ *    Returns: the number
+ *
+ *   Note: Whitespace and # comments before the number are skipped, and
+ *         the single whitespace character after it is consumed, which is
+ *         exactly what a raw raster expects after the height.
+ */
+unsigned read_header_number(FILE *fp)
 {
-    int width = Bit2_width(bitmap);
-    int height = Bit2_height(bitmap);
-
-    Bit2_T queued_map = Bit2_new(width, height);
+    int c = getc(fp);
 
-    /* Loop along top edge */
-    for (int i = 0; i < width; i++) {
-        if (Bit2_get(bitmap, i, 0) == 1) {
-            find_neighbors(bitmap, queued_map, i, 0);
+    while (isspace(c) || c == '#') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = getc(fp);
+            }
         }
+        c = getc(fp);
     }
 
-    /* Loop along right edge */
-    for (int i = 0; i < height; i++) {
-        if (Bit2_get(bitmap, width - 1, i) == 1) {
-            find_neighbors(bitmap, queued_map, width - 1, i);
-        }
-    }
+    assert(isdigit(c));
 
-    /* Loop along bottom edge */
-    for (int i = 0; i < width; i++) {
-        if (Bit2_get(bitmap, i, height - 1) == 1) {
-            find_neighbors(bitmap, queued_map, i, height - 1);
-        }
+    unsigned number = 0;
+    while (isdigit(c)) {
+        assert(number <= (unsigned)(INT_MAX - 9) / 10);
+        number = number * 10 + (c - '0');
+        c = getc(fp);
     }
 
-    /* Loop along left edge */
-    for (int i = 0; i < height; i++) {
-        if (Bit2_get(bitmap, 0, i) == 1) {
-            find_neighbors(bitmap, queued_map, 0, i);
-        }
-    }
-    Bit2_free(&queued_map);
+    assert(isspace(c));
+
+    return number;
 }
 
- /* find_neighbors
-  *    Purpose: Find the neighbors of the current pixel
-  * Parameters: A bitmap storing the pixels, a bitmap storing whether or not
-  *             the pixels have been queued, an int for the column number,
-  *             and an int for the row number
-  *    Returns: void
-  */
-void find_neighbors(Bit2_T bitmap, Bit2_T queued_map, int col, int row)
+/* read_plain_row
+ *    Purpose: Read one row of a plain (P1) raster and pack it as P4 bytes
+ * Parameters: a file pointer to the input stream, the buffer for the
+ *             packed row, and the width of the row
+ *    Returns: void
+ *
+ *   Note: Digits may be separated by any amount of whitespace, or by
+ *         none at all.
+ */
+void read_plain_row(FILE *fp, unsigned char *row, unsigned width)
 {
-    Seq_T neighbor_queue = Seq_new(100);
-    assert (neighbor_queue != NULL);
-
-    BlackPixelData bpd = malloc(sizeof(struct BlackPixelData));
-    assert (bpd != NULL);
+    memset(row, 0, (width + 7) / 8);
 
-    bpd->col = col;
-    bpd->row = row;
+    for (unsigned j = 0; j < width; j++) {
+        int c = getc(fp);
+        while (isspace(c)) {
+            c = getc(fp);
+        }
 
-    Seq_addhi(neighbor_queue, bpd);
-    
-    while (Seq_length(neighbor_queue) != 0) {
-        BlackPixelData curr_pixel = Seq_remlo(neighbor_queue);;
-        int col = curr_pixel->col;
-        int row = curr_pixel->row;
-        free(curr_pixel);
-        Bit2_put(bitmap, col, row, 0);
-        queue_neighbors(bitmap, queued_map, neighbor_queue, col, row);
+        assert(c == '0' || c == '1');
+        if (c == '1') {
+            row[j / 8] |= 0x80 >> (j % 8);
+        }
     }
-    
-    Seq_free(&neighbor_queue);
 }
 
-/* queue_neighbors
-  *    Purpose: Queue a given pixel's black neighbors
-  * Parameters: A bitmap storing the pixels, a bitmap storing whether or not
-  *             the pixels have been queued, a sequence storing a queue of 
-  *             pixels to process, an int for the column number, and an
-  *             int for the row number
+ /* remove_black_edges
+  *    Purpose: Remove the black edges, plus any specks or blobs the
+  *             options ask for
+  * Parameters: A bitmap with all the pixels and the parsed options
   *    Returns: void
+  *
+  *       Note: A black pixel is part of a black edge when a chain of
+  *             up/down/left/right black neighbors connects it to the
+  *             border, so the edges are exactly the 4-connected
+  *             components that touch the border.
   */
-void queue_neighbors(Bit2_T bitmap, Bit2_T queued_map, Seq_T neighbor_queue,
-                                               int curr_col, int curr_row)
+void remove_black_edges(Bit2_T bitmap, Options *options)
 {
-    /* Above neighbor */
-    if (curr_row != 0 && Bit2_get(bitmap, curr_col, curr_row - 1) == 1 &&
-                        Bit2_get(queued_map, curr_col, curr_row - 1) == 0) {
-        queue_neighbor(neighbor_queue, queued_map, curr_col, curr_row - 1);
-    }
+    Components_T components = Components_label(bitmap, 4);
 
-    /* Right neighbor */
-    if (curr_col != Bit2_width(bitmap) - 1
-                        && Bit2_get(bitmap, curr_col + 1, curr_row) == 1
-                        && Bit2_get(queued_map, curr_col + 1, curr_row) == 0) {
-        queue_neighbor(neighbor_queue, queued_map, curr_col + 1, curr_row);
+    if (options->print_stats) {
+        print_stats(components);
     }
 
-    /* Below neighbor */
-    if (curr_row != Bit2_height(bitmap) - 1
-                        && Bit2_get(bitmap, curr_col, curr_row + 1) == 1
-                        && Bit2_get(queued_map, curr_col, curr_row + 1) == 0) {
-        queue_neighbor(neighbor_queue, queued_map, curr_col, curr_row + 1);
-    }
+    Components_remove(components, bitmap, Components_touches_border, NULL);
 
-    /* Left neighbor */
-    if (curr_col != 0 && Bit2_get(bitmap, curr_col - 1, curr_row) == 1
-                      && Bit2_get(queued_map, curr_col - 1, curr_row) == 0) {
-        queue_neighbor(neighbor_queue, queued_map, curr_col - 1, curr_row);
+    if (options->min_area > 0) {
+        Components_remove(components, bitmap, Components_area_below,
+                                              &options->min_area);
+    }
+    if (options->max_area > 0) {
+        Components_remove(components, bitmap, Components_area_above,
+                                              &options->max_area);
     }
+
+    Components_free(&components);
 }
 
-/* queue_neighbor
-  *    Purpose: Enqueue a given black pixel to the neighbor queue
-  * Parameters: the sequence of pixels where the neighbor should be added,
-  *             a bitmap storing whether or not the pixels have been queued,
-  *             an int for the column number, and an int for the row number
+/* print_stats
+  *    Purpose: List every component's statistics on stderr
+  * Parameters: the labeled components
   *    Returns: void
   */
-void queue_neighbor(Seq_T neighbor_queue, Bit2_T queued_map, int col, int row)
+void print_stats(Components_T components)
 {
-    BlackPixelData neighbor_data = malloc(sizeof(struct BlackPixelData));
-    assert(neighbor_data != NULL);
+    for (int label = 0; label < Components_count(components); label++) {
+        Components_Stats stats = Components_stats(components, label);
 
-    neighbor_data->col = col;
-    neighbor_data->row = row;
-    Seq_addhi(neighbor_queue, neighbor_data);
-    Bit2_put(queued_map, col, row, 1);
+        fprintf(stderr, "%d: area %ld, box (%d, %d)-(%d, %d)%s\n", label,
+                stats.area, stats.min_col, stats.min_row, stats.max_col,
+                stats.max_row, stats.touches_border ? ", border" : "");
+    }
 }
 
 /* pbmwrite
@@ -268,43 +416,70 @@ void queue_neighbor(Seq_T neighbor_queue, Bit2_T queued_map, int col, int row)
   *             with proper header
   * Parameters: A bitmap storing the pixels
   *    Returns: void
+  *
+  *       Note: Each row is copied out with Bit2_get_row and each packed
+  *             byte is expanded to eight digits at once, then the row is
+  *             written in lines of at most 70 digits.
   */
 void pbmwrite(Bit2_T bitmap)
 {
+    int width = Bit2_width(bitmap);
+    int height = Bit2_height(bitmap);
+
     printf("P1\n");
-    printf("%d %d\n", Bit2_width(bitmap), Bit2_height(bitmap));
+    printf("%d %d\n", width, height);
     printf("1\n");
 
-    for (int i = 0; i < Bit2_height(bitmap); i++) {
-        for (int j = 0; j < Bit2_width(bitmap); j++) {
-            char output_char = Bit2_get(bitmap, j, i) + '0';
-            putchar(output_char);
+    /* digits[b] is the byte b written out as eight '0' and '1' digits */
+    static char digits[256][8];
+    for (int b = 0; b < 256; b++) {
+        for (int bit = 0; bit < 8; bit++) {
+            digits[b][bit] = '0' + ((b >> (7 - bit)) & 1);
+        }
+    }
+
+    int row_bytes = (width + 7) / 8;
+    unsigned char *row = malloc(row_bytes);
+    char *line = malloc((size_t)row_bytes * 8);
+    assert(row != NULL && line != NULL);
 
-            if (Bit2_width(bitmap) > 70 && j % 70 == 69){
-                putchar('\n');
+    for (int i = 0; i < height; i++) {
+        Bit2_get_row(bitmap, i, row);
+        for (int b = 0; b < row_bytes; b++) {
+            memcpy(line + (size_t)b * 8, digits[row[b]], 8);
+        }
+
+        if (width <= 70) {
+            fwrite(line, 1, width, stdout);
+        } else {
+            for (int j = 0; j < width; j += 70) {
+                int length = width - j < 70 ? width - j : 70;
+                fwrite(line + j, 1, length, stdout);
+                if (length == 70) {
+                    putchar('\n');
+                }
             }
         }
 
         putchar('\n');
     }
+
+    free(line);
+    free(row);
 }
 
 /* OpenFile
- *    Purpose: Attempts to open a file from the command line, throwing errors
- *             in the three cases described below.
- * Parameters: number of command line arguments as an int and the
- *             characters of each argument as a char array
+ *    Purpose: Attempts to open the file named on the command line, throwing
+ *             errors in the two cases described below.
+ * Parameters: the file name, or NULL to read standard input
  *    Returns: A file pointer for the file.
  *
  *       Note: Throws a checked runtime error if
- *             1. More than one argument is supplied
- *             2. The named input file cannot be opened
- *             3. An error is encountered reading from an input file
+ *             1. The named input file cannot be opened
+ *             2. An error is encountered reading from an input file
  */
-FILE *OpenFile(int argc, char *argv[])
+FILE *OpenFile(char *filename)
 {
-    assert(argc <= 2);
-
     /*
      * Set file pointer to stdin to handle command line input in the case
      * that no file is supplied
@@ -316,8 +491,8 @@ FILE *OpenFile(int argc, char *argv[])
      * If a file is supplied as an argument, open the file and make fp 
      * point to the opened filestream
      */
-    if (argc == 2) {
-        fp = fopen(argv[1], "r");
+    if (filename != NULL) {
+        fp = fopen(filename, "r");
     }
     
     assert(fp != NULL);
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include <bit2.h>
 
@@ -36,6 +37,21 @@ check_and_print(int i, int j, Bit2_T a, int b, void *p1)
         printf("ar[%d,%d]\n", i, j);
 }
 
+void
+count_ones(int i, int j, Bit2_T a, int b, void *p1)
+{
+        (void)i;
+        (void)j;
+        (void)a;
+        *((int *)p1) += b;
+}
+
+void
+sum_counts(void *cl, void *thread_cl)
+{
+        *((int *)cl) += *((int *)thread_cl);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -72,6 +88,91 @@ main(int argc, char *argv[])
         printf("Trying row major\n");
         Bit2_map_row_major(test_array, check_and_print, &OK);
 
+        printf("Trying parallel\n");
+        int ones = 0;
+        Bit2_map_parallel(test_array, 3, count_ones, &ones, sizeof(ones),
+                          sum_counts);
+        OK &= (ones == 1);
+
+        Bit2_free(&test_array);
+
+        printf("Trying wrap\n");
+        unsigned char page[2][2] = { { 0x80, 0x00 }, { 0x41, 0x00 } };
+        test_array = Bit2_wrap(&page[0][0], 10, 2, 2, 0);
+        OK &= (Bit2_get(test_array, 0, 0) == 1) &&
+              (Bit2_get(test_array, 1, 1) == 1) &&
+              (Bit2_get(test_array, 7, 1) == 1) &&
+              (Bit2_get(test_array, 9, 1) == 0);
+        Bit2_put(test_array, 9, 1, 1);
+        OK &= (page[1][1] == 0x40) && (Bit2_row(test_array, 1) == page[1]);
+
+        printf("Trying morphology\n");
+        Bit2_T grown = Bit2_dilate(test_array, Bit2_CROSS, 1);
+        int grown_ones = 0;
+        Bit2_map_row_major(grown, count_ones, &grown_ones);
+        OK &= (grown_ones == 11) && (Bit2_get(grown, 0, 1) == 1) &&
+              (Bit2_get(grown, 2, 1) == 1) && (Bit2_get(grown, 3, 1) == 0);
+        Bit2_T shrunk = Bit2_erode(grown, Bit2_CROSS, 1);
+        OK &= (Bit2_get(shrunk, 0, 0) == 1) && (Bit2_get(shrunk, 8, 1) == 0);
+        Bit2_free(&shrunk);
+        Bit2_free(&grown);
+
+        printf("Trying save and load\n");
+        FILE *saved = tmpfile();
+        Bit2_save(test_array, saved);
+        Bit2_free(&test_array);
+        rewind(saved);
+        test_array = Bit2_load(saved);
+        fclose(saved);
+        OK &= (Bit2_width(test_array) == 10) &&
+              (Bit2_height(test_array) == 2) &&
+              (Bit2_get(test_array, 0, 0) == 1) &&
+              (Bit2_get(test_array, 9, 1) == 1) &&
+              (Bit2_get(test_array, 8, 1) == 0);
+        Bit2_free(&test_array);
+
+        printf("Trying pool\n");
+        Pool_T pool = Pool_new(0);
+        for (int item = 0; item < 2; item++) {
+                test_array = Bit2_new_pool(DIM1, DIM2, pool);
+                OK &= (Bit2_get(test_array, DIM1 - 1, DIM2 - 1) == 0);
+                Bit2_put(test_array, DIM1 - 1, DIM2 - 1, 1);
+                Bit2_free(&test_array);
+                Pool_reset(pool);
+        }
+        Pool_free(&pool);
+
+        printf("Trying rows and transpose\n");
+        unsigned char row[19];
+        memset(row, 0xff, sizeof(row));
+        test_array = Bit2_new(150, 70);
+        Bit2_put_row(test_array, 3, row);
+        Bit2_get_row(test_array, 3, row);
+        OK &= (row[0] == 0xff) && (row[18] == 0xfc) &&
+              (Bit2_get(test_array, 149, 3) == 1) &&
+              (Bit2_get(test_array, 149, 4) == 0);
+        for (int i = 0; i < 150; i++) {
+                for (int j = 0; j < 70; j++) {
+                        Bit2_put(test_array, i, j, (i * 7 + j * 13) % 5 == 0);
+                }
+        }
+        Bit2_T flipped = Bit2_transpose(test_array);
+        OK &= (Bit2_width(flipped) == 70) && (Bit2_height(flipped) == 150);
+        for (int i = 0; i < 150; i++) {
+                for (int j = 0; j < 70; j++) {
+                        OK &= (Bit2_get(flipped, j, i) ==
+                               Bit2_get(test_array, i, j));
+                }
+        }
+        Bit2_free(&flipped);
+        Bit2_free(&test_array);
+
+        test_array = Bit2_new(13, 2);
+        row[1] = 0xff;
+        Bit2_put_row(test_array, 1, row);
+        Bit2_get_row(test_array, 1, row);
+        OK &= (row[0] == 0xff) && (row[1] == 0xf8) &&
+              (Bit2_get(test_array, 12, 1) == 1);
         Bit2_free(&test_array);
 
         printf("The array is %sOK!\n", (OK ? "" : "NOT "));
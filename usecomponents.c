@@ -0,0 +1,85 @@
+/*
+ *                      usecomponents.c
+ *
+ *         This program illustrates the use of the components interface.
+ *
+ *         Although it will catch some errors in some components
+ *         implementations it is NOT a thorough test program.
+ *
+ *         It labels a small picture with a border stroke, a speck, a
+ *         ring and a diagonal pair, checks the statistics, and then
+ *         removes components with each of the ready-made predicates.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <bit2.h>
+#include <components.h>
+
+const char *PICTURE[] = {
+        "1100000000",
+        "0100000000",
+        "0000011100",
+        "0001010100",
+        "0000011100",
+        "0010000000",
+        "0001000000",
+};
+
+int
+main(int argc, char *argv[])
+{
+        (void)argc;
+        (void)argv;
+
+        bool OK = true;
+        Bit2_T picture = Bit2_new(10, 7);
+
+        for (int row = 0; row < 7; row++) {
+                for (int col = 0; col < 10; col++) {
+                        Bit2_put(picture, col, row, PICTURE[row][col] - '0');
+                }
+        }
+
+        printf("Trying 4-connected labels\n");
+        Components_T components = Components_label(picture, 4);
+        OK &= (Components_count(components) == 5);
+
+        Components_Stats edge = Components_stats(components, 0);
+        OK &= (edge.area == 3) && edge.touches_border;
+
+        Components_Stats ring = Components_stats(components,
+                                Components_label_at(components, 5, 3));
+        OK &= (ring.area == 8) && !ring.touches_border &&
+              (ring.min_col == 5) && (ring.min_row == 2) &&
+              (ring.max_col == 7) && (ring.max_row == 4);
+        OK &= (Components_label_at(components, 6, 3) == -1);
+
+        printf("Trying 8-connected labels\n");
+        Components_T diagonal = Components_label(picture, 8);
+        OK &= (Components_count(diagonal) == 4);
+        OK &= (Components_label_at(diagonal, 2, 5) ==
+               Components_label_at(diagonal, 3, 6));
+        Components_free(&diagonal);
+
+        printf("Trying filters\n");
+        long speck = 2;
+        long blob = 5;
+        OK &= (Components_remove(components, picture,
+                                 Components_touches_border, NULL) == 2);
+        OK &= (Components_remove(components, picture,
+                                 Components_area_below, &speck) == 3);
+        OK &= (Bit2_get(picture, 0, 0) == 0) &&
+              (Bit2_get(picture, 3, 3) == 0) &&
+              (Bit2_get(picture, 5, 2) == 1);
+        OK &= (Components_remove(components, picture,
+                                 Components_area_above, &blob) == 1);
+        OK &= (Bit2_get(picture, 5, 2) == 0);
+
+        Components_free(&components);
+        Bit2_free(&picture);
+
+        printf("The array is %sOK!\n", (OK ? "" : "NOT "));
+}
@@ -0,0 +1,146 @@
+/*
+ *                      usesparse2.c
+ *
+ *         This program illustrates the use of the sparse2 interface.
+ *
+ *         Although it will catch some errors in some sparse2
+ *         implementations it is NOT a thorough test program.
+ *
+ *         It builds a mostly-white page, converts it to and from a
+ *         Sparse2, pushes one block through every representation with
+ *         Sparse2_put, and compares union and intersection against the
+ *         same operations done bit by bit on Bit2s.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <bit2.h>
+#include <sparse2.h>
+
+const int WIDTH = 700;
+const int HEIGHT = 400;
+
+bool
+same_bits(Bit2_T bit2, Sparse2_T sparse2)
+{
+        bool same = (Bit2_width(bit2) == Sparse2_width(sparse2)) &&
+                    (Bit2_height(bit2) == Sparse2_height(sparse2));
+
+        for (int row = 0; same && row < Bit2_height(bit2); row++) {
+                for (int col = 0; col < Bit2_width(bit2); col++) {
+                        same &= Bit2_get(bit2, col, row) ==
+                                Sparse2_get(sparse2, col, row);
+                }
+        }
+
+        return same;
+}
+
+void
+count_set(int col, int row, Sparse2_T a, void *p1)
+{
+        (void)a;
+        long *count = p1;
+
+        /* set bits must arrive in row-major order */
+        long index = (long)row * WIDTH + col;
+        if (index <= count[1]) {
+                count[0] = -1000000;
+        }
+        count[1] = index;
+        count[0]++;
+}
+
+Bit2_T
+make_page(unsigned seed, int black_percent)
+{
+        Bit2_T page = Bit2_new(WIDTH, HEIGHT);
+
+        srand(seed);
+        for (int row = 0; row < HEIGHT; row++) {
+                for (int col = 0; col < WIDTH; col++) {
+                        /* a solid black strip plus scattered specks */
+                        if (col < 20 || rand() % 100 < black_percent) {
+                                Bit2_put(page, col, row, 1);
+                        }
+                }
+        }
+
+        return page;
+}
+
+int
+main(int argc, char *argv[])
+{
+        (void)argc;
+        (void)argv;
+
+        bool OK = true;
+
+        Bit2_T page = make_page(1, 2);
+        Bit2_T other = make_page(2, 40);
+
+        printf("Trying round trip\n");
+        Sparse2_T sparse = Sparse2_from_bit2(page);
+        OK &= same_bits(page, sparse);
+
+        Bit2_T back = Sparse2_to_bit2(sparse);
+        Sparse2_T again = Sparse2_from_bit2(back);
+        OK &= same_bits(back, again) && same_bits(page, again);
+        Sparse2_free(&again);
+        Bit2_free(&back);
+
+        printf("Trying map_set\n");
+        long count[2] = { 0, -1 };
+        Sparse2_map_set(sparse, count_set, count);
+        OK &= (count[0] == Sparse2_count(sparse));
+
+        printf("Dense page: %d bytes, sparse page: %zu bytes\n",
+               Bit2_stride(page) * HEIGHT, Sparse2_memory(sparse));
+
+        printf("Trying put through every block kind\n");
+        Sparse2_T blank = Sparse2_new(WIDTH, HEIGHT);
+        for (int i = 0; i < 65536; i++) {
+                Sparse2_put(blank, i % WIDTH, i / WIDTH, 1);
+        }
+        OK &= (Sparse2_count(blank) == 65536);
+        for (int i = 0; i < 65536; i += 2) {
+                OK &= (Sparse2_put(blank, i % WIDTH, i / WIDTH, 0) == 1);
+        }
+        OK &= (Sparse2_count(blank) == 32768);
+        OK &= (Sparse2_get(blank, 1, 0) == 1) &&
+              (Sparse2_get(blank, 2, 0) == 0);
+        for (int i = 1; i < 65536; i += 2) {
+                Sparse2_put(blank, i % WIDTH, i / WIDTH, 0);
+        }
+        OK &= (Sparse2_count(blank) == 0);
+
+        Sparse2_T empty = Sparse2_new(WIDTH, HEIGHT);
+        OK &= (Sparse2_memory(blank) == Sparse2_memory(empty));
+        Sparse2_free(&empty);
+        Sparse2_free(&blank);
+
+        printf("Trying union and inter\n");
+        Sparse2_T sparse_other = Sparse2_from_bit2(other);
+        Sparse2_T either = Sparse2_union(sparse, sparse_other);
+        Sparse2_T both = Sparse2_inter(sparse, sparse_other);
+        for (int row = 0; row < HEIGHT; row++) {
+                for (int col = 0; col < WIDTH; col++) {
+                        int a = Bit2_get(page, col, row);
+                        int b = Bit2_get(other, col, row);
+                        OK &= Sparse2_get(either, col, row) == (a | b);
+                        OK &= Sparse2_get(both, col, row) == (a & b);
+                }
+        }
+
+        Sparse2_free(&both);
+        Sparse2_free(&either);
+        Sparse2_free(&sparse_other);
+        Sparse2_free(&sparse);
+        Bit2_free(&other);
+        Bit2_free(&page);
+
+        printf("The array is %sOK!\n", (OK ? "" : "NOT "));
+}
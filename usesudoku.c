@@ -0,0 +1,495 @@
+/*
+ *                      usesudoku.c
+ *
+ *         This program illustrates the use of the sudokucheck interface.
+ *
+ *         Although it will catch some errors in some sudokucheck
+ *         implementations it is NOT a thorough test program.
+ *
+ *         It checks a solved grid, grids that break only the row, only
+ *         the column or only the box rule, and a grid with a 0 cell,
+ *         read both as a compact stream and as concatenated PGMs,
+ *         and checks in-memory copies of them with every kernel and
+ *         a long compact stream of them on one and on several threads,
+ *         which must write the same lines.
+ *         It then checks plain and raw PGMs of other sizes, from 4 x 4
+ *         to 49 x 49, validates in-memory copies of the grids, 9 x 9
+ *         and padded 16 x 16 ones, and finally solves puzzles with one,
+ *         many and no solutions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sudokucheck.h>
+
+enum { SOLVED, BAD_ROW, BAD_COL, BAD_BOX, BAD_DIGIT, NUM_GRIDS };
+
+/* grid[g][row][col] for each kind of grid above */
+int grids[NUM_GRIDS][9][9];
+
+void
+make_grids(void)
+{
+        for (int row = 0; row < 9; row++) {
+                for (int col = 0; col < 9; col++) {
+                        /* the solution in testing/sudoku_test.pgm */
+                        int digit = (row % 3 * 3 + row / 3 + col) % 9 + 1;
+
+                        for (int g = 0; g < NUM_GRIDS; g++) {
+                                grids[g][row][col] = digit;
+                        }
+
+                        /* a cyclic Latin square: rows and columns are
+                         * fine, boxes are not */
+                        grids[BAD_BOX][row][col] = (row + col) % 9 + 1;
+                }
+        }
+
+        /* swapping two cells of a row within a box keeps the row and
+         * the box permutations, and likewise for a column */
+        grids[BAD_COL][0][0] = grids[SOLVED][0][1];
+        grids[BAD_COL][0][1] = grids[SOLVED][0][0];
+        grids[BAD_ROW][0][0] = grids[SOLVED][1][0];
+        grids[BAD_ROW][1][0] = grids[SOLVED][0][0];
+
+        grids[BAD_DIGIT][8][8] = 0;
+}
+
+void
+write_compact(FILE *fp, int g)
+{
+        for (int row = 0; row < 9; row++) {
+                for (int col = 0; col < 9; col++) {
+                        putc('0' + grids[g][row][col], fp);
+                }
+        }
+        putc('\n', fp);
+}
+
+void
+write_pgm(FILE *fp, int g)
+{
+        fprintf(fp, "P2\n9 9\n# puzzle %d\n9\n", g);
+        for (int row = 0; row < 9; row++) {
+                for (int col = 0; col < 9; col++) {
+                        fprintf(fp, "%d ", grids[g][row][col]);
+                }
+                putc('\n', fp);
+        }
+}
+
+bool
+check_stream(Sudoku_format format)
+{
+        FILE *stream = tmpfile();
+        for (int g = 0; g < NUM_GRIDS; g++) {
+                if (format == Sudoku_COMPACT) {
+                        write_compact(stream, g);
+                } else {
+                        write_pgm(stream, g);
+                }
+        }
+        rewind(stream);
+
+        Sudoku_T sudoku = Sudoku_new();
+        bool OK = true;
+        int count = 0;
+
+        while (Sudoku_read(sudoku, stream, format)) {
+                OK &= (Sudoku_check(sudoku) == (count == SOLVED));
+                count++;
+        }
+        OK &= (count == NUM_GRIDS);
+
+        Sudoku_free(&sudoku);
+        fclose(stream);
+
+        return OK && sudoku == NULL;
+}
+
+bool
+check_grids(Sudoku_kernel kernel)
+{
+        /* enough grids for two 32-grid blocks and a ragged tail */
+        enum { COUNT = 75 };
+        static uint8_t cells[COUNT][81];
+        static uint8_t solved[COUNT];
+        int expected = 0;
+
+        for (int i = 0; i < COUNT; i++) {
+                int g = i * 7 % NUM_GRIDS;
+                expected += (g == SOLVED);
+                for (int k = 0; k < 81; k++) {
+                        cells[i][k] = grids[g][k / 9][k % 9];
+                }
+        }
+        /* a digit far out of range must not look like any other */
+        cells[COUNT - 1][40] = 200;
+        expected -= (((COUNT - 1) * 7 % NUM_GRIDS) == SOLVED);
+
+        bool OK = (Sudoku_check_grids(&cells[0][0], COUNT, solved, kernel)
+                   == expected);
+        for (int i = 0; i < COUNT - 1; i++) {
+                OK &= (solved[i] == (i * 7 % NUM_GRIDS == SOLVED));
+        }
+        OK &= (solved[COUNT - 1] == 0);
+
+        return OK;
+}
+
+bool
+check_batch(int num_threads)
+{
+        /* many puzzles, with uneven spacing */
+        enum { COUNT = 20000 };
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+
+        for (int i = 0; i < COUNT; i++) {
+                int g = i * 7 % NUM_GRIDS;
+                for (int k = 0; k < 81; k++) {
+                        putc('0' + grids[g][k / 9][k % 9], in);
+                }
+                if (i % 3 == 0) {
+                        fputs("\n\n  ", in);
+                } else if (i % 3 == 1) {
+                        putc('\n', in);
+                }
+        }
+        rewind(in);
+
+        int unsolved = Sudoku_batch(in, out, num_threads);
+        rewind(out);
+
+        bool OK = true;
+        int expected = 0;
+        for (int i = 0; i < COUNT; i++) {
+                int solved = (i * 7 % NUM_GRIDS == SOLVED);
+                expected += !solved;
+                OK &= (getc(out) == (solved ? '0' : '1'));
+                OK &= (getc(out) == '\n');
+        }
+        OK &= (getc(out) == EOF && unsolved == expected);
+
+        fclose(in);
+        fclose(out);
+
+        return OK;
+}
+
+/* Checks that several threads write exactly what one thread does, on
+ * a stream long enough for several windows */
+bool
+check_batch_matches(void)
+{
+        enum { COUNT = 300000 };
+        FILE *in = tmpfile();
+        unsigned seed = 12345;
+
+        /* a pseudo-random mix of grids and spacing, so lines out of
+         * order would show */
+        for (int i = 0; i < COUNT; i++) {
+                seed = seed * 1103515245u + 12345u;
+                int g = (seed >> 16) % NUM_GRIDS;
+                for (int k = 0; k < 81; k++) {
+                        putc('0' + grids[g][k / 9][k % 9], in);
+                }
+                fputs((seed >> 8) % 3 == 0 ? "\r\n" : "\n", in);
+        }
+
+        FILE *outs[3];
+        int unsolved[3];
+        const int threads[3] = { 1, 3, 8 };
+        for (int t = 0; t < 3; t++) {
+                rewind(in);
+                outs[t] = tmpfile();
+                unsolved[t] = Sudoku_batch(in, outs[t], threads[t]);
+                rewind(outs[t]);
+        }
+
+        bool OK = (unsolved[1] == unsolved[0] && unsolved[2] == unsolved[0]);
+        int lines = 0;
+        for (;;) {
+                int c = getc(outs[0]);
+                OK &= (getc(outs[1]) == c && getc(outs[2]) == c);
+                if (c == EOF) {
+                        break;
+                }
+                lines += (c == '\n');
+        }
+        OK &= (lines == COUNT);
+
+        for (int t = 0; t < 3; t++) {
+                fclose(outs[t]);
+        }
+        fclose(in);
+
+        return OK;
+}
+
+/* Checks that a run of blank lines filling whole windows is
+ * skipped over rather than taken for the end of the stream */
+bool
+check_batch_gap(int num_threads)
+{
+        enum { GAP = 25000000 };
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+
+        for (int i = 0; i < 20; i++) {
+                if (i == 10) {
+                        for (int k = 0; k < GAP; k++) {
+                                putc('\n', in);
+                        }
+                }
+                write_compact(in, i % 2 ? SOLVED : BAD_BOX);
+        }
+        rewind(in);
+
+        bool OK = (Sudoku_batch(in, out, num_threads) == 10);
+        rewind(out);
+        for (int i = 0; i < 20; i++) {
+                OK &= (getc(out) == (i % 2 ? '0' : '1'));
+                OK &= (getc(out) == '\n');
+        }
+        OK &= (getc(out) == EOF);
+
+        fclose(in);
+        fclose(out);
+
+        return OK;
+}
+
+/* Writes an N*N by N*N PGM, plain or raw: solved, or broken as one of
+ * the grids above */
+void
+write_sized_pgm(FILE *fp, int n, int kind, bool raw)
+{
+        int side = n * n;
+
+        fprintf(fp, "P%c\n%d %d\n%d\n", raw ? '5' : '2', side, side, side);
+        for (int row = 0; row < side; row++) {
+                for (int col = 0; col < side; col++) {
+                        int digit = (row % n * n + row / n + col) % side + 1;
+
+                        if (kind == BAD_BOX) {
+                                digit = (row + col) % side + 1;
+                        } else if (kind == BAD_COL && row == 0 && col < 2) {
+                                digit = (1 - col) % side + 1;
+                        } else if (kind == BAD_ROW && col == 0 && row < 2) {
+                                digit = (row == 0 ? n : 0) % side + 1;
+                        } else if (kind == BAD_DIGIT && row == side - 1
+                                   && col == side - 1) {
+                                digit = 0;
+                        }
+                        if (raw) {
+                                putc(digit, fp);
+                        } else {
+                                fprintf(fp, "%d\t", digit);
+                        }
+                }
+                if (!raw) {
+                        putc('\n', fp);
+                }
+        }
+}
+
+bool
+check_sizes(void)
+{
+        FILE *stream = tmpfile();
+        for (int n = 2; n <= 7; n++) {
+                for (int g = 0; g < NUM_GRIDS; g++) {
+                        write_sized_pgm(stream, n, g, (n + g) % 2);
+                }
+        }
+        rewind(stream);
+
+        Sudoku_T sudoku = Sudoku_new();
+        bool OK = true;
+        int count = 0;
+
+        while (Sudoku_read(sudoku, stream, Sudoku_PGM)) {
+                OK &= (Sudoku_check(sudoku) == (count % NUM_GRIDS
+                                                == SOLVED));
+                count++;
+        }
+        OK &= (count == 6 * NUM_GRIDS);
+
+        Sudoku_free(&sudoku);
+        fclose(stream);
+
+        return OK;
+}
+
+/* Checks that validating a grid finds the given conflict */
+bool
+expect(Sudoku_result result, Sudoku_unit unit, int index, int row, int col)
+{
+        return result.valid == (unit == Sudoku_NONE) && result.unit == unit
+               && result.index == index && result.row == row
+               && result.col == col;
+}
+
+bool
+check_validate(void)
+{
+        uint8_t cells[NUM_GRIDS][81];
+        for (int g = 0; g < NUM_GRIDS; g++) {
+                for (int k = 0; k < 81; k++) {
+                        cells[g][k] = grids[g][k / 9][k % 9];
+                }
+        }
+
+        /* the first bad cell of each grid, and the unit it repeats in */
+        bool OK = true;
+        OK &= expect(Sudoku_validate(cells[SOLVED], 3, 9),
+                     Sudoku_NONE, -1, -1, -1);
+        OK &= expect(Sudoku_validate(cells[BAD_COL], 3, 9),
+                     Sudoku_COL, 0, 3, 0);
+        OK &= expect(Sudoku_validate(cells[BAD_ROW], 3, 9),
+                     Sudoku_ROW, 0, 0, 3);
+        OK &= expect(Sudoku_validate(cells[BAD_BOX], 3, 9),
+                     Sudoku_BOX, 0, 1, 0);
+        OK &= expect(Sudoku_validate(cells[BAD_DIGIT], 3, 9),
+                     Sudoku_DIGIT, 80, 8, 8);
+
+        /* a 16 x 16 grid in the left of rows 20 bytes apart, whose
+         * padding must be ignored */
+        enum { STRIDE = 20 };
+        static uint8_t padded[16 * STRIDE];
+        memset(padded, 0xff, sizeof(padded));
+        for (int row = 0; row < 16; row++) {
+                for (int col = 0; col < 16; col++) {
+                        padded[row * STRIDE + col] =
+                                (row % 4 * 4 + row / 4 + col) % 16 + 1;
+                }
+        }
+        OK &= expect(Sudoku_validate(padded, 4, STRIDE),
+                     Sudoku_NONE, -1, -1, -1);
+        padded[9 * STRIDE + 14] = padded[9 * STRIDE + 3];
+        OK &= expect(Sudoku_validate(padded, 4, STRIDE),
+                     Sudoku_ROW, 9, 9, 14);
+        padded[9 * STRIDE + 14] = 17;
+        OK &= expect(Sudoku_validate(padded, 4, STRIDE),
+                     Sudoku_DIGIT, 9 * 16 + 14, 9, 14);
+
+        return OK;
+}
+
+/* Solves one compact puzzle, returning the number of solutions found
+ * (at most two) and leaving the written result in out */
+int
+solve_one(const char *puzzle, char out[83])
+{
+        FILE *in = tmpfile();
+        FILE *written = tmpfile();
+        fputs(puzzle, in);
+        rewind(in);
+
+        Sudoku_T sudoku = Sudoku_new();
+        int read = Sudoku_read(sudoku, in, Sudoku_COMPACT);
+        int found = Sudoku_solve(sudoku, 2);
+        if (found > 0 && !Sudoku_check(sudoku)) {
+                found = -1;
+        }
+        Sudoku_write(sudoku, written, Sudoku_COMPACT);
+        rewind(written);
+        if (fgets(out, 83, written) == NULL || read != 1) {
+                found = -1;
+        }
+
+        Sudoku_free(&sudoku);
+        fclose(in);
+        fclose(written);
+
+        return found;
+}
+
+bool
+check_solve(void)
+{
+        char solved[82];
+        char puzzle[82];
+        char out[83];
+        bool OK = true;
+
+        for (int k = 0; k < 81; k++) {
+                solved[k] = '0' + grids[SOLVED][k / 9][k % 9];
+        }
+        solved[81] = '\0';
+
+        /* every fourth cell blank, some as '.' */
+        for (int k = 0; k < 81; k++) {
+                puzzle[k] = k % 4 != 0 ? solved[k] : (k % 8 ? '.' : '0');
+        }
+        puzzle[81] = '\0';
+        OK &= (solve_one(puzzle, out) == 1);
+        OK &= (strncmp(out, solved, 81) == 0 && out[81] == '\n');
+
+        /* Arto Inkala's hard puzzle has a single solution */
+        OK &= (solve_one("8..........36......7..9.2...5...7.......457..."
+                         "..1...3...1....68..85...1..9....4..", out) == 1);
+
+        /* an empty grid has many, and a repeated given none; the latter
+         * is written back as it was read */
+        memset(puzzle, '0', 81);
+        OK &= (solve_one(puzzle, out) == 2);
+        puzzle[0] = puzzle[1] = '5';
+        OK &= (solve_one(puzzle, out) == 0);
+        OK &= (strncmp(out, puzzle, 81) == 0);
+
+        return OK;
+}
+
+int
+main(int argc, char *argv[])
+{
+        (void)argc;
+        (void)argv;
+
+        bool OK = true;
+        make_grids();
+
+        printf("Trying compact stream\n");
+        OK &= check_stream(Sudoku_COMPACT);
+
+        printf("Trying PGM stream\n");
+        OK &= check_stream(Sudoku_PGM);
+
+        const char *names[] = { "best", "scalar", "SSE2", "AVX2" };
+        for (int k = Sudoku_BEST; k <= Sudoku_AVX2; k++) {
+                if (Sudoku_has_kernel(k)) {
+                        printf("Trying %s kernel\n", names[k]);
+                        OK &= check_grids(k);
+                }
+        }
+
+        printf("Trying batch on 1 and 4 threads\n");
+        OK &= check_batch(1);
+        OK &= check_batch(4);
+
+        printf("Trying batch on 3 and 8 threads against 1\n");
+        OK &= check_batch_matches();
+
+        printf("Trying batch across a long blank gap\n");
+        OK &= check_batch_gap(1);
+        OK &= check_batch_gap(4);
+
+        printf("Trying other sizes\n");
+        OK &= check_sizes();
+
+        printf("Trying validate\n");
+        OK &= check_validate();
+
+        printf("Trying solve\n");
+        OK &= check_solve();
+
+        printf("The sudoku checker is %sOK!\n", (OK ? "" : "NOT "));
+
+        return 0;
+}
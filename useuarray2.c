@@ -16,8 +16,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
+#include <arrayfile.h>
 #include <uarray2.h>
+#include <uarray2typed.h>
 
 typedef long number;
 
@@ -41,6 +44,468 @@ check_and_print(int i, int j, UArray2_T a, void *p1, void *p2)
         printf("ar[%d,%d]\n", i, j);
 }
 
+void
+sum_entries(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        (void)i;
+        (void)j;
+        (void)a;
+        *((number *)p2) += *((number *)p1);
+}
+
+void
+sum_totals(void *cl, void *thread_cl)
+{
+        *((number *)cl) += *((number *)thread_cl);
+}
+
+void
+count_entries(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        (void)i;
+        (void)j;
+        (void)a;
+        (void)p1;
+        (*((number *)p2))++;
+}
+
+void
+check_position(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        number *visits = p2;
+
+        /* every element holds its own coordinates */
+        if (UArray2_at(a, i, j) != p1 || *((number *)p1) != i * 1000 + j) {
+                visits[1] = 1;
+        }
+        visits[0]++;
+}
+
+bool
+check_order(UArray2_order order)
+{
+        const int width = 70;
+        const int height = 45;
+        UArray2_T array = UArray2_new_order(width, height, sizeof(number),
+                                            order);
+        bool OK = (UArray2_storage(array) == order);
+
+        for (int i = 0; i < width; i++) {
+                for (int j = 0; j < height; j++) {
+                        *((number *)UArray2_at(array, i, j)) = i * 1000 + j;
+                }
+        }
+
+        number visits[2] = { 0, 0 };
+        UArray2_map_default(array, check_position, visits);
+        UArray2_map_row_major(array, check_position, visits);
+        UArray2_map_col_major(array, check_position, visits);
+        UArray2_map_block_major(array, 0, check_position, visits);
+        UArray2_map_block_major(array, 7, check_position, visits);
+        OK &= (visits[0] == 5 * width * height) && (visits[1] == 0);
+
+        number total = 0;
+        number expected = 0;
+        UArray2_map_parallel(array, 3, sum_entries, &total, sizeof(total),
+                             sum_totals);
+        for (int i = 0; i < width; i++) {
+                expected += height * i * 1000 + height * (height - 1) / 2;
+        }
+        OK &= (total == expected);
+
+        FILE *saved = tmpfile();
+        UArray2_save(array, saved);
+        UArray2_free(&array);
+        rewind(saved);
+        array = UArray2_load(saved);
+        fclose(saved);
+
+        visits[0] = 0;
+        UArray2_map_default(array, check_position, visits);
+        OK &= (visits[0] == width * height) && (visits[1] == 0) &&
+              (UArray2_storage(array) == order);
+
+        UArray2_free(&array);
+
+        return OK;
+}
+
+bool
+check_rows(void)
+{
+        const int width = 100;
+        const int height = 6;
+        UArray2_T bytes = UArray2_new_order(width, height, sizeof(uint8_t),
+                                            UArray2_ROW_MAJOR);
+        UArray2_T copy = UArray2_new(width, height, sizeof(uint8_t));
+        bool OK = true;
+
+        for (int j = 0; j < height; j++) {
+                uint8_t value = 7 * j;
+                UArray2_fill_row(bytes, j, &value);
+                UArray2_copy_row(copy, height - 1 - j, bytes, j);
+
+                size_t stride;
+                int length;
+                uint8_t *row = UArray2_row(bytes, j, &stride, &length);
+                OK &= ((uintptr_t)row % UARRAY2_ALIGN == 0) &&
+                      (stride == 1) && (length == width);
+                for (int i = 0; i < length; i++) {
+                        OK &= (row[i] == value);
+                }
+        }
+
+        /* the copy is column-major, so its rows are strided */
+        for (int j = 0; j < height; j++) {
+                size_t stride;
+                uint8_t *row = UArray2_row(copy, j, &stride, NULL);
+                OK &= (stride >= (size_t)height) &&
+                      (stride % UARRAY2_ALIGN == 0);
+                for (int i = 0; i < width; i++) {
+                        OK &= (row[i * stride] == 7 * (height - 1 - j));
+                }
+        }
+
+        uint8_t *col = UArray2_col(copy, 3, NULL, NULL);
+        OK &= ((uintptr_t)col % UARRAY2_ALIGN == 0) &&
+              (col[height - 1] == 0);
+
+        UArray2_free(&copy);
+        UArray2_free(&bytes);
+
+        return OK;
+}
+
+bool
+check_pool(void)
+{
+        Pool_T pool = Pool_new(4096);
+        bool OK = true;
+        void *first_item = NULL;
+        void *first_typed = NULL;
+
+        /* each item gets fresh zeroed arrays from the same memory */
+        for (int item = 0; item < 3; item++) {
+                UArray2_T small = UArray2_new_pool(9, 9, sizeof(int),
+                                                   UArray2_COL_MAJOR, pool);
+                UArray2_T big = UArray2_new_pool(300, 20, sizeof(number),
+                                                 UArray2_ROW_MAJOR, pool);
+
+                UArray2_u16_T typed = UArray2_u16_new_pool(16, 16,
+                                                           UArray2_ROW_MAJOR,
+                                                           pool);
+
+                /* the typed handle comes from the pool too */
+                if (item == 0) {
+                        first_item = small;
+                        first_typed = typed;
+                }
+                OK &= ((void *)small == first_item);
+                OK &= ((void *)typed == first_typed) &&
+                      (UArray2_u16_get(typed, 15, 15) == 0);
+                UArray2_u16_put(typed, 15, 15, item + 1);
+                OK &= (*((int *)UArray2_at(small, 8, 8)) == 0) &&
+                      (*((number *)UArray2_at(big, 299, 19)) == 0);
+
+                *((int *)UArray2_at(small, 8, 8)) = item + 1;
+                *((number *)UArray2_at(big, 299, 19)) = item + 1;
+
+                UArray2_free(&small);
+                UArray2_u16_free(&typed);
+                Pool_reset(pool);
+        }
+
+        Pool_free(&pool);
+        OK &= (pool == NULL);
+
+        return OK;
+}
+
+void
+scale_f32(int i, int j, UArray2_f32_T a, float *elem, void *cl)
+{
+        (void)a;
+        *elem = (i + j) * *((float *)cl);
+}
+
+bool
+check_typed(void)
+{
+        bool OK = true;
+        UArray2_i32_T ints = UArray2_i32_new(DIM1, DIM2);
+        UArray2_u8_T bytes = UArray2_u8_new_order(DIM1, DIM2,
+                                                  UArray2_ROW_MAJOR);
+
+        UArray2_i32_put(ints, DIM1 - 1, DIM2 - 1, MARKER);
+        OK &= (*((int32_t *)UArray2_at(UArray2_i32_generic(ints),
+                                       DIM1 - 1, DIM2 - 1)) == MARKER);
+        OK &= (UArray2_i32_col(ints, 1)[2] == 0);
+
+        uint8_t *row = UArray2_u8_row(bytes, 3);
+        for (int i = 0; i < DIM1; i++) {
+                row[i] = i;
+        }
+        OK &= (UArray2_u8_get(bytes, 4, 3) == 4) &&
+              (UArray2_u8_at(bytes, 2, 3) == &row[2]);
+
+        UArray2_f32_T floats = UArray2_f32_new(DIM1, DIM2);
+        float scale = 0.5;
+        UArray2_f32_map_default(floats, scale_f32, &scale);
+        OK &= (UArray2_f32_get(floats, 3, 4) == 3.5);
+
+        UArray2_f32_free(&floats);
+        UArray2_u8_free(&bytes);
+        UArray2_i32_free(&ints);
+
+        return OK && ints == NULL;
+}
+
+void
+add_double(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        (void)i;
+        (void)j;
+        (void)a;
+        *((double *)p2) += *((double *)p1);
+}
+
+void
+combine_doubles(void *result, void *partial)
+{
+        *((double *)result) += *((double *)partial);
+}
+
+bool
+check_reduce(void)
+{
+        UArray2_T values = UArray2_new_order(300, 500, sizeof(double),
+                                             UArray2_ROW_MAJOR);
+        bool OK = true;
+
+        /* magnitudes vary so that the summation order shows in the bits */
+        for (int i = 0; i < 300; i++) {
+                for (int j = 0; j < 500; j++) {
+                        *((double *)UArray2_at(values, i, j)) =
+                                1.0 / (1 + i * 500 + j) + (j % 7) * 1e6;
+                }
+        }
+
+        double zero = 0.0;
+        double serial = 0.0;
+        UArray2_reduce_parallel(values, 1, add_double, &zero, &serial,
+                                sizeof(double), combine_doubles);
+
+        for (int threads = 2; threads <= 5; threads++) {
+                double parallel = 0.0;
+                UArray2_reduce_parallel(values, threads, add_double, &zero,
+                                        &parallel, sizeof(double),
+                                        combine_doubles);
+                OK &= (parallel == serial);
+        }
+        OK &= (serial > 500 * 300 * 2.9e6 && serial < 500 * 300 * 3.1e6);
+
+        /* the map spans several chunks, each element visited once */
+        for (int threads = 1; threads <= 5; threads++) {
+                number visits = 0;
+                UArray2_map_parallel(values, threads, count_entries,
+                                     &visits, sizeof(visits), sum_totals);
+                OK &= (visits == 500 * 300);
+        }
+
+        UArray2_free(&values);
+
+        return OK;
+}
+
+bool
+check_views(UArray2_order order)
+{
+        const int width = 40;
+        const int height = 30;
+        UArray2_T array = UArray2_new_order(width, height, sizeof(number),
+                                            order);
+        bool OK = true;
+
+        for (int i = 0; i < width; i++) {
+                for (int j = 0; j < height; j++) {
+                        *((number *)UArray2_at(array, i, j)) = i * 1000 + j;
+                }
+        }
+
+        UArray2_T region = UArray2_view(array, 5, 3, 20, 10);
+        UArray2_T strided = UArray2_view_strided(array, 1, 2, 13, 7, 3, 4);
+        UArray2_T nested = UArray2_view_strided(region, 2, 1, 6, 3, 3, 2);
+
+        OK &= (UArray2_width(region) == 20) &&
+              (UArray2_height(region) == 10) &&
+              (UArray2_at(region, 0, 0) == UArray2_at(array, 5, 3)) &&
+              (UArray2_at(strided, 12, 6) == UArray2_at(array, 37, 26)) &&
+              (UArray2_at(nested, 5, 2) == UArray2_at(array, 22, 8));
+
+        /* a write through a view shows in the parent */
+        *((number *)UArray2_at(nested, 1, 1)) = MARKER;
+        OK &= (*((number *)UArray2_at(array, 10, 6)) == MARKER);
+        *((number *)UArray2_at(array, 10, 6)) = 10 * 1000 + 6;
+
+        number sums[2] = { 0, 0 };
+        UArray2_map_row_major(strided, sum_entries, &sums[0]);
+        UArray2_map_parallel(strided, 3, sum_entries, &sums[1],
+                             sizeof(number), sum_totals);
+        number expected = 0;
+        for (int i = 0; i < 13; i++) {
+                for (int j = 0; j < 7; j++) {
+                        expected += (1 + 3 * i) * 1000 + 2 + 4 * j;
+                }
+        }
+        OK &= (sums[0] == expected) && (sums[1] == expected);
+
+        /* a saved view loads as an ordinary array with the same values */
+        FILE *saved = tmpfile();
+        UArray2_save(nested, saved);
+        rewind(saved);
+        UArray2_T loaded = UArray2_load(saved);
+        fclose(saved);
+        OK &= (UArray2_width(loaded) == 6) && (UArray2_height(loaded) == 3);
+        for (int i = 0; i < 6; i++) {
+                for (int j = 0; j < 3; j++) {
+                        OK &= (*((number *)UArray2_at(loaded, i, j)) ==
+                               *((number *)UArray2_at(nested, i, j)));
+                }
+        }
+
+        UArray2_free(&loaded);
+        UArray2_free(&nested);
+        UArray2_free(&strided);
+        UArray2_free(&region);
+        UArray2_free(&array);
+
+        return OK;
+}
+
+/* returns the flags in the arrayfile header at path */
+uint32_t
+file_flags(const char *path)
+{
+        ArrayFile_header header;
+        FILE *fp = fopen(path, "rb");
+        ArrayFile_read_header(&header, ArrayFile_UARRAY2, fp);
+        fclose(fp);
+
+        return header.flags;
+}
+
+bool
+check_file(UArray2_order order)
+{
+        const char *path = "useuarray2.map";
+        const int width = 70;
+        const int height = 45;
+        UArray2_T array = UArray2_new_file(path, width, height,
+                                           sizeof(number), order);
+        bool OK = (UArray2_storage(array) == order) &&
+                  (*((number *)UArray2_at(array, width - 1, height - 1))
+                                                                == 0);
+
+        UArray2_advise(array, UArray2_ADVISE_SEQUENTIAL);
+        for (int i = 0; i < width; i++) {
+                for (int j = 0; j < height; j++) {
+                        *((number *)UArray2_at(array, i, j)) = i * 1000 + j;
+                }
+        }
+        UArray2_sync(array);
+        UArray2_free(&array);
+
+        /* reopened in place, then read back while still unsealed */
+        number visits[2] = { 0, 0 };
+        array = UArray2_open_file(path, 0);
+        UArray2_advise(array, UArray2_ADVISE_RANDOM);
+        UArray2_map_default(array, check_position, visits);
+        UArray2_free(&array);
+        OK &= (file_flags(path) == ARRAYFILE_UNSEALED);
+
+        FILE *saved = fopen(path, "rb");
+        array = UArray2_load(saved);
+        fclose(saved);
+        UArray2_map_default(array, check_position, visits);
+        UArray2_free(&array);
+
+        /* sealed, then read back through the checked path */
+        array = UArray2_open_file(path, 1);
+        UArray2_seal(array);
+        UArray2_free(&array);
+        OK &= (file_flags(path) == 0);
+
+        saved = fopen(path, "rb");
+        array = UArray2_load(saved);
+        fclose(saved);
+        UArray2_map_default(array, check_position, visits);
+        OK &= (visits[0] == 3 * width * height) && (visits[1] == 0) &&
+              (UArray2_storage(array) == order);
+        UArray2_free(&array);
+
+        remove(path);
+
+        return OK;
+}
+
+void
+fill_pattern(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        unsigned char *bytes = p1;
+        (void)p2;
+
+        for (int k = 0; k < UArray2_size(a); k++) {
+                bytes[k] = (i * 31 + j * 7 + k) & 0xff;
+        }
+}
+
+/* checks that element (i, j) holds the pattern of (j, i) */
+void
+check_transposed(int i, int j, UArray2_T a, void *p1, void *p2)
+{
+        unsigned char *bytes = p1;
+
+        for (int k = 0; k < UArray2_size(a); k++) {
+                *((bool *)p2) &= (bytes[k] == ((j * 31 + i * 7 + k) & 0xff));
+        }
+}
+
+bool
+check_transpose(void)
+{
+        UArray2_order orders[] = { UArray2_COL_MAJOR, UArray2_ROW_MAJOR,
+                                   UArray2_BLOCKED };
+        size_t sizes[] = { 1, 2, 4, 8, 12 };
+        bool OK = true;
+
+        for (int s = 0; s < 5; s++) {
+                for (int from = 0; from < 3; from++) {
+                        UArray2_T src = UArray2_new_order(70, 45, sizes[s],
+                                                          orders[from]);
+                        UArray2_map_default(src, fill_pattern, NULL);
+
+                        for (int to = 0; to < 3; to++) {
+                                UArray2_T dst = UArray2_new_order(45, 70,
+                                                sizes[s], orders[to]);
+                                UArray2_transpose(dst, src);
+                                UArray2_map_default(dst, check_transposed,
+                                                    &OK);
+                                UArray2_free(&dst);
+                        }
+                        UArray2_free(&src);
+
+                        UArray2_T square = UArray2_new_order(70, 70,
+                                                sizes[s], orders[from]);
+                        UArray2_map_default(square, fill_pattern, NULL);
+                        UArray2_transpose_square(square);
+                        UArray2_map_default(square, check_transposed, &OK);
+                        UArray2_free(&square);
+                }
+        }
+
+        return OK;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -63,8 +528,56 @@ main(int argc, char *argv[])
         printf("Trying row major\n");
         UArray2_map_row_major(test_array, check_and_print, &OK);
 
+        printf("Trying parallel\n");
+        number total = 0;
+        UArray2_map_parallel(test_array, 3, sum_entries, &total,
+                             sizeof(total), sum_totals);
+        OK &= (total == MARKER);
+
+        printf("Trying save and load\n");
+        FILE *saved = tmpfile();
+        UArray2_save(test_array, saved);
+        UArray2_free(&test_array);
+        rewind(saved);
+        test_array = UArray2_load(saved);
+        fclose(saved);
+        OK &= (UArray2_width(test_array) == DIM1) &&
+              (UArray2_height(test_array) == DIM2) &&
+              (UArray2_size(test_array) == ELEMENT_SIZE) &&
+              (*((number *)UArray2_at(test_array, DIM1 - 1, DIM2 - 1))
+                                                            == MARKER);
+
         UArray2_free(&test_array);
 
+        printf("Trying storage orders\n");
+        OK &= check_order(UArray2_COL_MAJOR);
+        OK &= check_order(UArray2_ROW_MAJOR);
+        OK &= check_order(UArray2_BLOCKED);
+
+        printf("Trying row pointers, copy and fill\n");
+        OK &= check_rows();
+
+        printf("Trying pool\n");
+        OK &= check_pool();
+
+        printf("Trying typed variants\n");
+        OK &= check_typed();
+
+        printf("Trying parallel reduce\n");
+        OK &= check_reduce();
+
+        printf("Trying views\n");
+        OK &= check_views(UArray2_COL_MAJOR);
+        OK &= check_views(UArray2_ROW_MAJOR);
+
+        printf("Trying file-backed arrays\n");
+        OK &= check_file(UArray2_COL_MAJOR);
+        OK &= check_file(UArray2_ROW_MAJOR);
+        OK &= check_file(UArray2_BLOCKED);
+
+        printf("Trying transpose\n");
+        OK &= check_transpose();
+
         printf("The array is %sOK!\n", (OK ? "" : "NOT "));
 
         (void)argc;